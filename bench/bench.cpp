@@ -0,0 +1,423 @@
+#define SDL_MAIN_HANDLED
+#include "SDL3/SDL.h"
+
+#include <algorithm>
+#include <chrono>
+#include <cmath>
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <memory>
+#include <thread>
+#include <unordered_set>
+#include <vector>
+
+#include "Sudoku.h"
+#include "BatchSolver.h"
+
+// Headless solver benchmarks. Prints one JSON object on stdout, SDL_Log
+// output goes to stderr.
+// usage: sudoku_bench [puzzles per level] [section ...]
+
+using Clock = std::chrono::steady_clock;
+
+const char* kLevelNames[] = { "easy", "medium", "hard", "evil" };
+// Keeps the optimizer from dropping benchmarked work
+volatile std::uint64_t benchSink;
+
+double secondsSince(Clock::time_point start) {
+    return std::chrono::duration<double>(Clock::now() - start).count();
+}
+
+// Repeats run until it has taken at least minSeconds, returns items per second
+template <typename F>
+double itemsPerSecond(std::size_t items, F&& run, double minSeconds = 0.2) {
+    std::size_t reps = 0;
+    auto start = Clock::now();
+    double seconds;
+    do {
+        run();
+        ++reps;
+        seconds = secondsSince(start);
+    } while (seconds < minSeconds);
+    return items * reps / seconds;
+}
+
+// Prints the key of the next top-level member, with a separator after the first
+void beginMember(const char* key) {
+    static bool first = true;
+    std::printf("%s\n  \"%s\": ", first ? "" : ",", key);
+    first = false;
+}
+
+std::vector<Board> makePuzzles(Sudoku& sudoku, int level, int count) {
+    std::vector<Board> puzzles;
+    for (int n = 0; n < count; ++n) {
+        sudoku.setDifficulty(level);
+        sudoku.generateSudoku();
+        puzzles.push_back(sudoku.board());
+    }
+    return puzzles;
+}
+
+// Masks of every placed digit, conflicting ones included
+UnitMasks unitMasks(const Board& board) {
+    UnitMasks units;
+    for (int cell = 0; cell < 9 * 9; ++cell)
+        if (board[cell] != 0)
+            units.add(cell, board[cell]);
+    return units;
+}
+
+// Compares a kernel with the scalar scan on random boards. Digits are placed
+// without checking the units, so contradictions and singles both come up.
+bool matchesScalar(ScanKernel kernel, int boards = 20000) {
+    Rng rng(1);
+    CandidateScan expected, actual;
+    for (int n = 0; n < boards; ++n) {
+        Board board{};
+        int filled = rng.range(0, 9 * 9);
+        for (int i = 0; i < filled; ++i)
+            board[rng.bounded(9 * 9)] = std::uint8_t(rng.range(1, 9));
+        UnitMasks units = unitMasks(board);
+        scanCandidatesScalar(board, units.rows, units.cols, units.boxes, expected);
+        kernel(board, units.rows, units.cols, units.boxes, actual);
+        if (std::memcmp(expected.masks, actual.masks, sizeof(expected.masks)) != 0
+            || expected.singles[0] != actual.singles[0] || expected.singles[1] != actual.singles[1]
+            || expected.contradiction != actual.contradiction)
+            return false;
+    }
+    return true;
+}
+
+// Scan throughput of every kernel level and solve time with it bound
+void benchKernels(const std::vector<Board> (&puzzles)[4]) {
+    const KernelLevel levels[] = { KernelLevel::Scalar, KernelLevel::Sse41, KernelLevel::Avx2, KernelLevel::Avx512 };
+    KernelLevel bound = activeKernelLevel;
+    Solver solver;
+    solver.branching = Solver::Branching::MostConstrained;
+
+    beginMember("kernels");
+    std::printf("[");
+    bool first = true;
+    for (KernelLevel level : levels) {
+        std::printf("%s\n    { \"name\": \"%s\", \"supported\": %s", first ? "" : ",", kernelName(level), kernelSupported(level, cpuFeatures()) ? "true" : "false");
+        first = false;
+        if (!kernelSupported(level, cpuFeatures())) {
+            std::printf(" }");
+            continue;
+        }
+        bindKernel(level);
+        std::printf(", \"matches_scalar\": %s", matchesScalar(activeScanKernel) ? "true" : "false");
+
+        const std::vector<Board>& evil = puzzles[3];
+        CandidateScan scan;
+        UnitMasks units = unitMasks(evil[0]);
+        const int scans = 1000000;
+        auto start = Clock::now();
+        for (int n = 0; n < scans; ++n) {
+            activeScanKernel(evil[n % evil.size()], units.rows, units.cols, units.boxes, scan);
+            benchSink = scan.singles[0];
+        }
+        double scanSeconds = secondsSince(start);
+        std::printf(", \"ns_per_scan\": %.2f, \"solve_us\": {", scanSeconds * 1e9 / scans);
+
+        // Best of several passes, the first one warms the caches and the
+        // branch predictor and the rest filter out scheduler noise
+        for (int level = 0; level < 4; ++level) {
+            double best = 1e30;
+            for (int pass = 0; pass < 5; ++pass) {
+                start = Clock::now();
+                for (const Board& puzzle : puzzles[level]) {
+                    Board board = puzzle;
+                    solver.load(board);
+                    solver.solve(board);
+                }
+                best = std::min(best, secondsSince(start));
+            }
+            std::printf("%s\"%s\": %.2f", level ? ", " : " ", kLevelNames[level], best * 1e6 / puzzles[level].size());
+        }
+        std::printf(" } }");
+    }
+    std::printf("\n  ]");
+    bindKernel(bound);
+}
+
+// Lock-step batch solving against one scalar solve per puzzle
+void benchBatch(const std::vector<Board> (&puzzles)[4]) {
+    BatchSolver batch;
+    Solver solver;
+    solver.branching = Solver::Branching::MostConstrained;
+    DancingLinks dlx;
+
+    beginMember("batch");
+    std::printf("{ \"lanes\": %d", kBatchLanes);
+    for (int level = 0; level < 4; ++level) {
+        const std::vector<Board>& boards = puzzles[level];
+        std::vector<Board> solutions(boards.size());
+        std::unique_ptr<bool[]> solved(new bool[boards.size()]);
+        BatchStats stats;
+        double lockStep = itemsPerSecond(boards.size(), [&] {
+            stats = batch.solve(boards.data(), solutions.data(), solved.get(), boards.size());
+        });
+        double scalar = itemsPerSecond(boards.size(), [&] {
+            for (const Board& puzzle : boards) {
+                Board board = puzzle;
+                solver.load(board);
+                solver.solve(board);
+            }
+        });
+        double exactCover = itemsPerSecond(boards.size(), [&] {
+            for (const Board& puzzle : boards) {
+                Board board = puzzle;
+                dlx.solve(board);
+            }
+        });
+        std::printf(",\n    \"%s\": { \"puzzles_per_sec\": %.0f, \"scalar_puzzles_per_sec\": %.0f, \"dlx_puzzles_per_sec\": %.0f, \"lock_step\": %zu, \"fallback\": %zu, \"unsolvable\": %zu }",
+            kLevelNames[level], lockStep, scalar, exactCover, stats.lockStep, stats.fallback, stats.unsolvable);
+    }
+    std::printf("\n  }");
+}
+
+// solveBatch over every level mixed together, for 1..N pool threads
+void benchThreads(const std::vector<Board> (&puzzles)[4]) {
+    std::vector<Board> boards;
+    for (const std::vector<Board>& level : puzzles)
+        boards.insert(boards.end(), level.begin(), level.end());
+    std::vector<Board> solutions(boards.size());
+    unsigned hardware = std::max(std::thread::hardware_concurrency(), 1u);
+
+    beginMember("threads");
+    std::printf("[");
+    double single = 0;
+    for (unsigned threads = 1; threads <= hardware; ++threads) {
+        ThreadPool pool(threads);
+        double rate = itemsPerSecond(boards.size(), [&] {
+            solveBatch(boards, solutions, pool);
+        });
+        if (threads == 1)
+            single = rate;
+        std::printf("%s\n    { \"threads\": %u, \"puzzles_per_sec\": %.0f, \"speedup\": %.2f }", threads == 1 ? "" : ",", threads, rate, rate / single);
+    }
+    std::printf("\n  ]");
+}
+
+Board parseBoard(const char* str) {
+    Board board{};
+    for (int i = 0; i < 9 * 9; ++i)
+        board[i] = str[i] == '.' ? 0 : std::uint8_t(str[i] - '0');
+    return board;
+}
+
+// Wall-clock scaling of one search split over the pool: a board built to
+// defeat row-major backtracking, and counting a sparse board's solutions up
+// to a limit. Every thread count runs the same split and is timed against a
+// one-thread pool; the sequential solver and the exact-cover backend visit
+// subtrees in another order, so they are only listed for reference. Both searches stop early, so how many
+// nodes they visit still depends on scheduling: the node rate against the
+// one-thread pool is the scaling that does not.
+void benchSplit(const std::vector<Board> (&puzzles)[4]) {
+    Board hard = parseBoard("..............3.85..1.2.......5.7.....4...1...9.......5......73..2.1........4...9");
+    Board sparse = puzzles[3][0];
+    for (int cell = 0; cell < 9 * 9; cell += 2)
+        sparse[cell] = 0;
+    const int countLimit = 100000;
+
+    // Powers of two up to the core count, and at least up to four
+    unsigned cores = std::max(std::thread::hardware_concurrency(), 1u);
+    std::vector<unsigned> threads;
+    for (unsigned n = 1; n < std::max(cores, 4u); n *= 2)
+        threads.push_back(n);
+    threads.push_back(std::max(cores, 4u));
+
+    Solver solver;
+    solver.propagate = false;
+    DancingLinks dlx;
+    // Runs one search, returns its time in milliseconds and its nodes
+    auto measure = [&](const Board& puzzle, bool count, ThreadPool* pool, std::uint64_t& nodes, int& solutions) {
+        Board board = puzzle;
+        auto start = Clock::now();
+        solver.load(board);
+        if (count)
+            solutions = pool ? solver.countSolutionsParallel(countLimit, *pool) : solver.countSolutions(countLimit);
+        else
+            solutions = (pool ? solver.solveParallel(board, *pool) : solver.solve(board)) ? 1 : 0;
+        double ms = secondsSince(start) * 1e3;
+        nodes = solver.nodes;
+        return ms;
+    };
+
+    beginMember("split");
+    std::printf("{ \"cores\": %u", cores);
+    const char* names[] = { "hard_solve", "sparse_count" };
+    const Board* boards[] = { &hard, &sparse };
+    for (int i = 0; i < 2; ++i) {
+        std::uint64_t nodes;
+        int solutions;
+        double sequential = measure(*boards[i], i == 1, nullptr, nodes, solutions);
+        std::printf(",\n    \"%s\": { \"sequential\": { \"ms\": %.2f, \"nodes\": %llu, \"solutions\": %d },",
+            names[i], sequential, static_cast<unsigned long long>(nodes), solutions);
+        // Exact cover picks the tightest constraint, not the tightest cell
+        Board board = *boards[i];
+        auto start = Clock::now();
+        solutions = i == 1 ? dlx.countSolutions(board, countLimit) : dlx.solve(board) ? 1 : 0;
+        std::printf(" \"dlx\": { \"ms\": %.2f, \"nodes\": %llu, \"solutions\": %d }, \"pool\": [",
+            secondsSince(start) * 1e3, static_cast<unsigned long long>(dlx.nodes), solutions);
+        double singleMs = 0, singleRate = 0;
+        for (std::size_t t = 0; t < threads.size(); ++t) {
+            ThreadPool pool(threads[t]);
+            double ms = measure(*boards[i], i == 1, &pool, nodes, solutions);
+            double rate = nodes / ms;
+            if (t == 0) {
+                singleMs = ms;
+                singleRate = rate;
+            }
+            std::printf("%s\n      { \"threads\": %u, \"ms\": %.2f, \"nodes\": %llu, \"mnodes_per_sec\": %.2f, \"speedup\": %.2f, \"rate_speedup\": %.2f, \"solutions\": %d }",
+                t ? "," : "", threads[t], ms, static_cast<unsigned long long>(nodes), rate * 1e-3, singleMs / ms, rate / singleRate, solutions);
+        }
+        std::printf(" ] }");
+    }
+    std::printf("\n  }");
+}
+
+// Whether band (line 0..2) or stack (3..5) is pure: the digit sets of its
+// mini-rows (mini-columns) are the same three in all of its boxes. That holds
+// for exactly 2 of every 56 of all grids (Felgenhauer and Jarvis), whatever
+// the digit labels are.
+bool pureLine(const Board& grid, int line) {
+    std::uint16_t first[3]{}, second[3]{};
+    for (int r = 0; r < 3; ++r) {
+        int row = line % 3 * 3 + r;
+        for (int k = 0; k < 3; ++k) {
+            first[r] |= 1 << grid[line < 3 ? row * 9 + k : k * 9 + row];
+            second[r] |= 1 << grid[line < 3 ? row * 9 + 3 + k : (3 + k) * 9 + row];
+        }
+    }
+    for (std::uint16_t set : second)
+        if (set != first[0] && set != first[1] && set != first[2])
+            return false;
+    return true;
+}
+
+// Random full grids: generation rate, and how often bands and stacks are pure
+// over a large sample. Per-cell digit counts can't tell a biased generator
+// from a uniform one once digits are relabelled at random; the pure rate can.
+// Its standard error comes from batch means, as the chain repeats grids.
+void benchGrids() {
+    GridGenerator generator;
+    Rng rng;
+    Board grid;
+    std::uint64_t nodes = 0;
+    const int sample = 200000, batches = 100;
+    const double expected = 2.0 / 56;
+    std::vector<int> pure(batches, 0);
+    std::unordered_set<std::uint64_t> distinct;
+    auto start = Clock::now();
+    for (int n = 0; n < sample; ++n) {
+        generator.generate(grid, rng);
+        nodes += generator.nodes;
+        for (int line = 0; line < 6; ++line)
+            pure[n / (sample / batches)] += pureLine(grid, line);
+        std::uint64_t hash = 14695981039346656037ull;
+        for (std::uint8_t v : grid)
+            hash = (hash ^ v) * 1099511628211ull;
+        distinct.insert(hash);
+    }
+    double seconds = secondsSince(start);
+
+    double perBatch = 6.0 * sample / batches, mean = 0, variance = 0;
+    for (int count : pure)
+        mean += count / perBatch / batches;
+    for (int count : pure)
+        variance += (count / perBatch - mean) * (count / perBatch - mean) / (batches - 1);
+    double z = (mean - expected) / std::sqrt(variance / batches);
+
+    // The same seed must give the same puzzle at every level
+    Sudoku a, b;
+    bool reproducible = true;
+    for (int level = 0; level < 4; ++level) {
+        a.generate(0x5eed + level, level);
+        b.generate(0x5eed + level, level);
+        reproducible = reproducible && a.board() == b.board();
+    }
+
+    beginMember("grids");
+    std::printf("{ \"sample\": %d, \"grids_per_sec\": %.0f, \"placements_per_grid\": %.2f, \"acceptance\": %.3f, \"distinct\": %zu, \"pure_rate\": %.5f, \"pure_expected\": %.5f, \"pure_z\": %.2f, \"seed_reproducible\": %s }",
+        sample, sample / seconds, double(nodes) / sample, double(generator.accepted) / generator.proposals, distinct.size(),
+        mean, expected, z, reproducible ? "true" : "false");
+}
+
+// Minimal puzzles at a few clue targets: rate, how often the target is met
+// and how much of the order search early termination saves
+void benchMinimal() {
+    ThreadPool pool;
+    Rng rng;
+    const int targets[] = { 24, 22, 21 };
+    const int count = 20;
+
+    beginMember("minimal");
+    std::printf("{ \"threads\": %u", pool.size());
+    for (int target : targets) {
+        MinimalGenerator generator;
+        generator.options.targetClues = target;
+        int reached = 0, clues = 0;
+        auto start = Clock::now();
+        for (int n = 0; n < count; ++n) {
+            Board puzzle;
+            reached += generator.generate(puzzle, rng, pool);
+            for (std::uint8_t v : puzzle)
+                clues += v != 0;
+        }
+        double seconds = secondsSince(start);
+        const MinimalGenerator::Stats& stats = generator.stats;
+        std::printf(",\n    \"%d\": { \"puzzles_per_sec\": %.1f, \"reached\": %d, \"mean_clues\": %.2f, \"grids_per_puzzle\": %.2f, \"orders_per_puzzle\": %.1f, \"abandoned\": %.3f, \"solver_calls_per_puzzle\": %.0f }",
+            target, count / seconds, reached, double(clues) / count, double(stats.grids) / count, double(stats.orders) / count,
+            double(stats.abandoned) / stats.orders, double(stats.solverCalls) / count);
+    }
+    std::printf("\n  }");
+}
+
+bool wanted(int argc, char** argv, const char* section) {
+    bool any = false;
+    for (int i = 2; i < argc; ++i) {
+        any = true;
+        if (std::strcmp(argv[i], section) == 0)
+            return true;
+    }
+    return !any;
+}
+
+int main(int argc, char** argv) {
+    int count = argc > 1 ? std::atoi(argv[1]) : 50;
+    if (count <= 0)
+        count = 50;
+
+    Sudoku sudoku;
+    std::vector<Board> puzzles[4];
+    for (int level = 0; level < 4; ++level)
+        puzzles[level] = makePuzzles(sudoku, level, count);
+
+    std::printf("{");
+    beginMember("cpu");
+    std::printf("\"%s\"", describeCpu(cpuFeatures()).c_str());
+    beginMember("kernel");
+    std::printf("\"%s\"", kernelName(activeKernelLevel));
+    beginMember("puzzles_per_level");
+    std::printf("%d", count);
+
+    if (wanted(argc, argv, "kernels"))
+        benchKernels(puzzles);
+    if (wanted(argc, argv, "batch"))
+        benchBatch(puzzles);
+    if (wanted(argc, argv, "threads"))
+        benchThreads(puzzles);
+    if (wanted(argc, argv, "split"))
+        benchSplit(puzzles);
+    if (wanted(argc, argv, "grids"))
+        benchGrids();
+    if (wanted(argc, argv, "minimal"))
+        benchMinimal();
+
+    std::printf("\n}\n");
+    return 0;
+}
@@ -0,0 +1,110 @@
+#define SDL_MAIN_HANDLED
+#include "SDL3/SDL.h"
+
+#include <algorithm>
+#include <atomic>
+#include <chrono>
+#include <cstdio>
+#include <cstdlib>
+#include <new>
+#include <vector>
+
+#include "Sudoku.h"
+
+// Generator throughput per difficulty level, and a check that the exact-cover
+// backend counts solutions without allocating. Prints one JSON object on
+// stdout, SDL_Log output goes to stderr.
+// usage: sudoku_genbench [puzzles per level] [first seed]
+
+using Clock = std::chrono::steady_clock;
+
+// Every allocation of the process goes through here, so the counter covers
+// the generator and everything it calls
+std::atomic<std::uint64_t> allocations{ 0 };
+
+void* operator new(std::size_t size) {
+    ++allocations;
+    if (void* p = std::malloc(size ? size : 1))
+        return p;
+    throw std::bad_alloc();
+}
+
+void operator delete(void* p) noexcept { std::free(p); }
+void operator delete(void* p, std::size_t) noexcept { std::free(p); }
+
+const char* kLevelNames[] = { "easy", "medium", "hard", "evil" };
+
+struct Report
+{
+    std::vector<double> latencies;
+    std::uint64_t solverCalls = 0, allocations = 0, clues = 0;
+    double seconds = 0;
+};
+
+// Times one generate call per puzzle
+template <typename F>
+Report measure(Sudoku& sudoku, int count, F&& generate) {
+    Report report;
+    report.latencies.reserve(count);
+    auto start = Clock::now();
+    for (int n = 0; n < count; ++n) {
+        std::uint64_t allocated = allocations;
+        auto begin = Clock::now();
+        generate(n);
+        report.latencies.push_back(std::chrono::duration<double, std::micro>(Clock::now() - begin).count());
+        report.allocations += allocations - allocated;
+        report.solverCalls += sudoku.solverCalls;
+        report.clues += std::count_if(sudoku.board().begin(), sudoku.board().end(), [](std::uint8_t v) { return v != 0; });
+    }
+    report.seconds = std::chrono::duration<double>(Clock::now() - start).count();
+    return report;
+}
+
+void print(const char* name, const Report& report, bool last) {
+    std::vector<double> sorted = report.latencies;
+    std::sort(sorted.begin(), sorted.end());
+    std::size_t count = sorted.size();
+    auto percentile = [&](double p) { return sorted[std::min(count - 1, std::size_t(p * count))]; };
+    std::printf("    \"%s\": { \"puzzles_per_sec\": %.1f, \"p50_us\": %.1f, \"p99_us\": %.1f, \"max_us\": %.1f, \"solver_calls_per_puzzle\": %.1f, \"allocations_per_puzzle\": %.1f, \"mean_clues\": %.2f }%s\n",
+        name, count / report.seconds, percentile(0.5), percentile(0.99), sorted.back(),
+        double(report.solverCalls) / count, double(report.allocations) / count, double(report.clues) / count, last ? "" : ",");
+}
+
+int main(int argc, char** argv) {
+    int count = argc > 1 ? std::atoi(argv[1]) : 200;
+    if (count <= 0)
+        count = 200;
+    std::uint64_t seed = argc > 2 ? std::strtoull(argv[2], nullptr, 0) : 1;
+
+    Sudoku sudoku;
+    ThreadPool pool;
+
+    std::printf("{\n  \"puzzles_per_level\": %d,\n  \"seed\": %llu,\n  \"threads\": %u,\n  \"levels\": {\n",
+        count, static_cast<unsigned long long>(seed), pool.size());
+    for (int level = 0; level < 4; ++level) {
+        Report report = measure(sudoku, count, [&](int n) { sudoku.generate(seed + n, level); });
+        print(kLevelNames[level], report, false);
+    }
+    // What a puzzle cache with minimalEvilClues = 22 builds its Evil queue from
+    Report minimal = measure(sudoku, count, [&](int n) {
+        sudoku.rng.seed(seed + n);
+        sudoku.generateMinimal(22, pool);
+    });
+    print("evil_minimal_22", minimal, true);
+    std::printf("  },\n");
+
+    // The exact-cover backend restores its node pool instead of rebuilding
+    // it, so after construction counting must not touch the heap
+    DancingLinks dlx;
+    std::uint64_t dlxAllocations = 0;
+    int unique = 0;
+    for (int n = 0; n < count; ++n) {
+        sudoku.generate(seed + n, 3);
+        std::uint64_t allocated = allocations;
+        unique += dlx.countSolutions(sudoku.board(), 2) == 1;
+        dlxAllocations += allocations - allocated;
+    }
+    std::printf("  \"dlx_count_solutions\": { \"calls\": %d, \"unique\": %d, \"allocations\": %llu }\n}\n",
+        count, unique, static_cast<unsigned long long>(dlxAllocations));
+    return 0;
+}
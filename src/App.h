@@ -7,9 +7,13 @@
 #include "imgui_impl_sdl3.h"
 #include "imgui_impl_sdlrenderer3.h"
 
+#include <optional>
 #include <string>
 
 #include "Sudoku.h"
+#include "AsyncSolver.h"
+#include "PuzzleCache.h"
+#include "FrameArena.h"
 
 class App
 {
@@ -46,6 +50,8 @@ private:
     int window_width, window_height;
     float scale_factor_x{}, scale_factor_y{}, scale_factor{};
     bool isMouseHidden;
+    // Strings built while drawing a frame, reset by ImguiNewFrame
+    FrameArena frame_arena;
 
 public:
     // Sudoku
@@ -57,7 +63,17 @@ public:
     SDL_FRect rects[9 * 9]{};
     float rect_size = 60.f;
     int difficulty_level = 1;
+    // The cheat solve runs in the background, this only bounds how long it may take
+    int cheat_budget_ms = 5000;
+    SolveStatus cheat_status = SolveStatus::Solved;
     Sudoku sudoku;
+    // Both own worker threads, ~App stops them before SDL shuts down
+    std::optional<AsyncSolver> cheat_solver{ std::in_place };
+    // Ready puzzles per difficulty so reset never generates on the frame. Evil
+    // stays on the plain generator: the minimal search would take a thread
+    // pool the size of the machine away from rendering. Its workers start
+    // once SDL is up, it stays empty if the constructor failed.
+    std::optional<PuzzleCache> puzzle_cache;
     void sudokuStartGame();
     void sudokuDrawGrid();
     void sudokuDrawGridLines();
@@ -98,6 +114,7 @@ App::App(const char* window_title, int window_width, int window_height, Uint32 w
     SDL_RendererInfo info;
     SDL_GetRendererInfo(renderer, &info);
     SDL_Log("Current SDL_Renderer: %s", info.name);
+    SDL_Log("CPU: %s, candidate kernel: %s", describeCpu(cpuFeatures()).c_str(), kernelName(activeKernelLevel));
     SDL_SetHint(SDL_HINT_RENDER_SCALE_QUALITY, "2");
 
     SDL_DisplayID display = SDL_GetPrimaryDisplay();
@@ -115,10 +132,19 @@ App::App(const char* window_title, int window_width, int window_height, Uint32 w
     scale_factor_x = static_cast<float>(window_width) / initial_window_width;
     scale_factor_y = static_cast<float>(window_height) / initial_window_height;
     scale_factor = std::min(scale_factor_x, scale_factor_y);
+
+    puzzle_cache.emplace(PuzzleCache::Config{ 4, 1, std::chrono::milliseconds(20) });
 }
 
 App::~App()
 {
+    // Join the workers first, they may still be logging through SDL
+    puzzle_cache.reset();
+    cheat_solver.reset();
+#ifndef NDEBUG
+    SDL_Log("Frame arena high water: %zu of %zu bytes", frame_arena.highWater, FrameArena::kCapacity);
+#endif
+
     ImGui_ImplSDLRenderer3_Shutdown();
     ImGui_ImplSDL3_Shutdown();
     ImGui::DestroyContext();
@@ -149,6 +175,7 @@ ImGuiIO& App::ImguiInit()
 
 ImGuiIO& App::ImguiNewFrame()
 {
+    frame_arena.reset();
     ImGui_ImplSDLRenderer3_NewFrame();
     ImGui_ImplSDL3_NewFrame();
     ImGui::NewFrame();
@@ -206,12 +233,12 @@ void App::DrawString(const std::string& str, const ImVec2 &position, float size,
     ImGuiWindowFlags window_flags = ImGuiWindowFlags_NoDecoration | ImGuiWindowFlags_NoBackground | ImGuiWindowFlags_AlwaysAutoResize | ImGuiWindowFlags_NoMove | ImGuiWindowFlags_NoDocking;
 
     ImGui::SetNextWindowPos(position);
-    ImGui::Begin(std::string("String " + std::to_string(discriminator)).c_str(), nullptr, window_flags);
+    ImGui::Begin(frame_arena.format("String %d", discriminator), nullptr, window_flags);
     ImGui::PushStyleColor(ImGuiCol_Text, color);
     float old_size = ImGui::GetFont()->Scale;
     ImGui::GetFont()->Scale *= size / 100;
     ImGui::PushFont(ImGui::GetFont());
-    ImGui::Text(str.c_str());
+    ImGui::TextUnformatted(str.c_str());
     ImGui::GetFont()->Scale = old_size;
     ImGui::PopFont();
     ImGui::PopStyleColor();
@@ -231,12 +258,12 @@ void App::DrawNumber(int number, const ImVec2& position, float size, const ImVec
     ImGuiWindowFlags window_flags = ImGuiWindowFlags_NoDecoration | ImGuiWindowFlags_NoBackground | ImGuiWindowFlags_AlwaysAutoResize | ImGuiWindowFlags_NoMove | ImGuiWindowFlags_NoDocking;
 
     ImGui::SetNextWindowPos(position);
-    ImGui::Begin(std::string("Number " + std::to_string(x)).c_str(), nullptr, window_flags);
+    ImGui::Begin(frame_arena.format("Number %d", x), nullptr, window_flags);
     ImGui::PushStyleColor(ImGuiCol_Text, color);
     float old_size = ImGui::GetFont()->Scale;
     ImGui::GetFont()->Scale *= size / 100;
     ImGui::PushFont(ImGui::GetFont());
-    ImGui::Text(std::to_string(number).c_str());
+    ImGui::Text("%d", number);
     ImGui::GetFont()->Scale = old_size;
     ImGui::PopFont();
     ImGui::PopStyleColor();
@@ -245,12 +272,20 @@ void App::DrawNumber(int number, const ImVec2& position, float size, const ImVec
 
 void App::sudokuStartGame()
 {
-    sudoku.setDifficulty(difficulty_level);
-    sudoku.generateSudoku();
-    sudoku.initializeCellNumbers();
+    // A cheat solve still running belongs to the old board
+    cheat_solver->discard();
+    Board puzzle;
+    if (puzzle_cache && puzzle_cache->pop(difficulty_level, puzzle))
+        sudoku.setBoard(puzzle);
+    else
+    {
+        sudoku.setDifficulty(difficulty_level);
+        sudoku.generateSudoku();
+    }
+    SDL_Log("%d", int(std::count_if(sudoku.board().begin(), sudoku.board().end(), [](std::uint8_t num) { return num != 0; })));
     sudoku.initializeStates();
-    sudoku.start = sudoku.grid;
-    sudoku.solved = sudoku.grid;
+    sudoku.start = sudoku.board();
+    sudoku.solved = sudoku.board();
     valid = false;
     check_color = { 1.f, 0.f, 0.f, 1.f };
 }
@@ -303,25 +338,16 @@ void App::sudokuDrawShadows(const Uint32 colors[3][4])
 {
     SDL_SetRenderDrawBlendMode(renderer, SDL_BLENDMODE_BLEND);
     SDL_SetRenderDrawColor(renderer, colors[0][0], colors[0][1], colors[0][2], colors[0][3]);
-    auto colored = sudoku.getAllColored();
-    for (auto& i : colored)
-        SDL_RenderFillRect(renderer, &rects[get1DIndex(i.first, i.second, 9)]);
+    CellSet colored = sudoku.getAllColored();
+    colored.forEach([&](int cell) { SDL_RenderFillRect(renderer, &rects[cell]); });
 
     SDL_SetRenderDrawColor(renderer, colors[1][0], colors[1][1], colors[1][2], colors[1][3]);
-    std::vector<int> allOcc = sudoku.findAll();
-    for (int i = 0; i < allOcc.size(); i++)
-    {
-        if (allOcc[i] == sudoku.active)
-            continue;
-        SDL_RenderFillRect(renderer, &rects[allOcc[i]]);
-    }
+    CellSet allOcc = sudoku.findAll();
+    allOcc.forEach([&](int cell) { SDL_RenderFillRect(renderer, &rects[cell]); });
 
     // Overlap
     SDL_SetRenderDrawColor(renderer, colors[2][0], colors[2][1], colors[2][2], colors[2][3]);
-    for (int i = 0; i < allOcc.size(); i++)
-        for (int j = 0; j < colored.size(); j++)
-            if (allOcc[i] == get1DIndex(colored[j].first, colored[j].second, 9))
-                SDL_RenderFillRect(renderer, &rects[allOcc[i]]);
+    (allOcc & colored).forEach([&](int cell) { SDL_RenderFillRect(renderer, &rects[cell]); });
 }
 
 void App::sudokuDrawNumbers()
@@ -332,7 +358,7 @@ void App::sudokuDrawNumbers()
         if (sudoku.states[i] == State::Start)
             number_color = { 245.f / 255.f, 245 / 255.f, 225 / 255.f, 1.0f };
 
-        DrawNumber(sudoku.cell_numbers[i], { rects[i].x + 11 * scale_factor, rects[i].y }, 300 * scale_factor, number_color, i);
+        DrawNumber(sudoku.board()[i], { rects[i].x + 11 * scale_factor, rects[i].y }, 300 * scale_factor, number_color, i);
     }
 }
 
@@ -345,8 +371,7 @@ void App::sudokuProcessKeyboardInput(const SDL_Keycode keycode)
         {
             if (sudoku.states[sudoku.active] != State::Start)
             {
-                sudoku.cell_numbers[sudoku.active] = i;
-                sudoku.updateGrid();
+                sudoku.setCell(sudoku.active, i);
             }
         }
     }
@@ -356,8 +381,7 @@ void App::sudokuProcessKeyboardInput(const SDL_Keycode keycode)
     {
         if (sudoku.states[sudoku.active] != State::Start)
         {
-            sudoku.cell_numbers[sudoku.active] = 0;
-            sudoku.updateGrid();
+            sudoku.setCell(sudoku.active, 0);
         }
     }
     // SDLK_KP_1 = 1073741913
@@ -367,8 +391,7 @@ void App::sudokuProcessKeyboardInput(const SDL_Keycode keycode)
         {
             if (sudoku.states[sudoku.active] != State::Start)
             {
-                sudoku.cell_numbers[sudoku.active] = i + 1;
-                sudoku.updateGrid();
+                sudoku.setCell(sudoku.active, i + 1);
             }
         }
     }
@@ -436,6 +459,14 @@ void App::sudokuDrawImguiWindow()
 {
     static bool unsaved_document = false;
     static bool cheat = false;
+    Board cheat_solution;
+    std::uint64_t cheat_nodes;
+    if (cheat_solver->poll(cheat_solution, cheat_status, cheat_nodes))
+    {
+        if (cheat_status == SolveStatus::Solved)
+            sudoku.solved = cheat_solution;
+        SDL_Log("cheat status %d after %llu nodes", static_cast<int>(cheat_status), (unsigned long long)cheat_nodes);
+    }
     ImGuiWindowFlags window_flags = ImGuiWindowFlags_AlwaysAutoResize | ImGuiWindowFlags_NoDocking;
     if (unsaved_document)   window_flags |= ImGuiWindowFlags_UnsavedDocument;
     ImGui::SetNextWindowPos({ 650, 100 }, ImGuiCond_FirstUseEver);
@@ -453,7 +484,7 @@ void App::sudokuDrawImguiWindow()
     {
         cheat = true;
         sudoku.solved = sudoku.start;
-        sudoku.solveSudoku(sudoku.solved);
+        cheat_solver->start(sudoku.start, sudoku.backend, std::chrono::milliseconds(cheat_budget_ms));
     }
     if (ImGui::BeginItemTooltip())
     {
@@ -465,7 +496,7 @@ void App::sudokuDrawImguiWindow()
 
     if (ImGui::Button("check"))
     {
-        valid = sudoku.isValidSudoku(sudoku.grid);
+        valid = sudoku.isValidSudoku(sudoku.board());
         valid ? check_color = { 0.f, 1.f, 0.f, 1.f } : check_color = { 1.f, 0.f, 0.f, 1.f };
     }
     ImGui::SameLine();
@@ -501,6 +532,34 @@ void App::sudokuDrawImguiWindow()
         ImGui::EndCombo();
     }
 
+    const char* symmetries[] = { "No symmetry", "Rotational", "Mirror", "Diagonal" };
+    int symmetry_idx = static_cast<int>(sudoku.symmetry);
+    ImGui::SameLine();
+    if (ImGui::BeginCombo("##symmetry", symmetries[symmetry_idx], ImGuiComboFlags_WidthFitPreview))
+    {
+        for (int n = 0; n < IM_ARRAYSIZE(symmetries); n++)
+        {
+            const bool is_selected = (symmetry_idx == n);
+            if (ImGui::Selectable(symmetries[n], is_selected) && symmetry_idx != n)
+            {
+                sudoku.symmetry = static_cast<ClueSymmetry>(n);
+                if (puzzle_cache)
+                    puzzle_cache->setSymmetry(sudoku.symmetry);
+                unsaved_document = true;
+            }
+            if (is_selected)
+                ImGui::SetItemDefaultFocus();
+        }
+        ImGui::EndCombo();
+    }
+
+    const char* backends[] = { "Backtracking", "Dancing Links" };
+    int backend_idx = static_cast<int>(sudoku.backend);
+    if (ImGui::Combo("##backend", &backend_idx, backends, IM_ARRAYSIZE(backends)))
+        sudoku.backend = static_cast<SolverBackend>(backend_idx);
+
+    if (puzzle_cache)
+        ImGui::Text("cache %llu hits, %llu misses", (unsigned long long)puzzle_cache->hits, (unsigned long long)puzzle_cache->misses);
 
     ImGui::Checkbox("Click", &click);
     if (click)
@@ -509,9 +568,9 @@ void App::sudokuDrawImguiWindow()
         {
             for (int j = 0; j < 3; j++)
             {
-                if (ImGui::Button(std::to_string(3 * i + j + 1).c_str()))
+                if (ImGui::Button(frame_arena.format("%d", 3 * i + j + 1)))
                     if (sudoku.states[sudoku.active] != State::Start)
-                        sudoku.cell_numbers[sudoku.active] = 3 * i + j + 1;
+                        sudoku.setCell(sudoku.active, 3 * i + j + 1);
                 if (j == 2)
                     break;
                 ImGui::SameLine();
@@ -519,7 +578,7 @@ void App::sudokuDrawImguiWindow()
         }
         if (ImGui::Button("   0   "))
             if (sudoku.states[sudoku.active] != State::Start)
-                sudoku.cell_numbers[sudoku.active] = 0;
+                sudoku.setCell(sudoku.active, 0);
     }
     ImGui::End();
 
@@ -527,28 +586,33 @@ void App::sudokuDrawImguiWindow()
     {
         ImGui::SetNextWindowPos({ sudoku_window_pos.x - sudoku_window_size.y / 4, sudoku_window_pos.y + sudoku_window_size.y + 10 }, ImGuiCond_Appearing);
         ImGui::Begin("Cheat", &cheat, ImGuiWindowFlags_AlwaysAutoResize | ImGuiWindowFlags_NoDocking);
+        if (cheat_solver->pending())
+            ImGui::Text("solving...");
+        else if (cheat_status == SolveStatus::TimedOut)
+            ImGui::TextColored({ 1.f, 0.f, 0.f, 1.f }, "no solution within %d ms", cheat_budget_ms);
+        else if (cheat_status == SolveStatus::Unsolvable)
+            ImGui::TextColored({ 1.f, 0.f, 0.f, 1.f }, "no solution");
         for (int i = 0; i < 9; i++)
         {
             for (int j = 0; j < 9; j++)
             {
                 if (sudoku.states[get1DIndex(i, j, 9)] != State::Start)
                 {
-                    ImGui::TextColored({ 1.f, 0.f, 0.f, 1.f }, std::to_string(sudoku.solved[i][j]).c_str());
+                    ImGui::TextColored({ 1.f, 0.f, 0.f, 1.f }, "%d", sudoku.solved[get1DIndex(i, j, 9)]);
                     if (j == 8) break;
                     ImGui::SameLine();
                 }
                 else
                 {
-                    ImGui::Text(std::to_string(sudoku.solved[i][j]).c_str());
+                    ImGui::Text("%d", sudoku.solved[get1DIndex(i, j, 9)]);
                     if (j == 8) break;
                     ImGui::SameLine();
                 }
             }
         }
-        if (ImGui::Button("fill"))
+        if (!cheat_solver->pending() && ImGui::Button("fill"))
         {
-            sudoku.grid = sudoku.solved;
-            sudoku.initializeCellNumbers();
+            sudoku.setBoard(sudoku.solved);
         }
 
 
@@ -0,0 +1,152 @@
+#pragma once
+
+#include <atomic>
+#include <chrono>
+#include <condition_variable>
+#include <cstdint>
+#include <mutex>
+#include <thread>
+#include "Board.h"
+#include "Sudoku.h"
+
+// Solves one board at a time on its own worker thread so the render loop
+// never waits on a search. Requests go through a short mutex, results come
+// back lock-free: the worker fills a single result slot and then publishes
+// the request's generation, and the owner only reads the slot once the
+// published generation matches the latest request. Starting a new request or
+// calling discard cancels the running search and its result is dropped.
+class AsyncSolver
+{
+public:
+    AsyncSolver();
+    ~AsyncSolver();
+
+    // Starts solving puzzle in the background, replacing any running request
+    void start(const Board& puzzle, SolverBackend backend, std::chrono::milliseconds budget);
+    // Cancels the running request, its result will never be returned
+    void discard();
+    // True while the latest request has not been collected by poll
+    bool pending() const { return collected != requested; }
+    // Returns true once, when the result of the latest request is ready
+    bool poll(Board& solution, SolveStatus& status, std::uint64_t& nodes);
+
+private:
+    struct Request
+    {
+        Board puzzle{};
+        SolverBackend backend = SolverBackend::Backtracking;
+        std::chrono::milliseconds budget{};
+    };
+
+    struct Result
+    {
+        Board solution{};
+        SolveStatus status = SolveStatus::Solved;
+        std::uint64_t nodes = 0;
+    };
+
+    void run();
+
+    // Owner side: latest request handed out and latest result collected
+    std::uint64_t requested = 0, collected = 0;
+
+    std::mutex mutex;
+    std::condition_variable wake;
+    Request request;
+    std::uint64_t queued = 0;
+    bool stop = false;
+    std::atomic<bool> cancel{ false };
+
+    Result result;
+    std::atomic<std::uint64_t> published{ 0 };
+
+    Solver solver;
+    DancingLinks dlx;
+    std::thread worker;
+};
+
+AsyncSolver::AsyncSolver()
+    : worker(&AsyncSolver::run, this)
+{
+}
+
+AsyncSolver::~AsyncSolver() {
+    {
+        std::lock_guard<std::mutex> lock(mutex);
+        stop = true;
+        cancel = true;
+    }
+    wake.notify_one();
+    worker.join();
+}
+
+void AsyncSolver::start(const Board& puzzle, SolverBackend backend, std::chrono::milliseconds budget) {
+    {
+        std::lock_guard<std::mutex> lock(mutex);
+        request = { puzzle, backend, budget };
+        queued = ++requested;
+        cancel = true;
+    }
+    wake.notify_one();
+}
+
+void AsyncSolver::discard() {
+    if (!pending())
+        return;
+    // Moving past the running generation makes its result stale
+    {
+        std::lock_guard<std::mutex> lock(mutex);
+        cancel = true;
+        queued = 0;
+    }
+    collected = ++requested;
+}
+
+bool AsyncSolver::poll(Board& solution, SolveStatus& status, std::uint64_t& nodes) {
+    if (!pending() || published.load(std::memory_order_acquire) != requested)
+        return false;
+    // The worker does not touch the slot again until the next start
+    solution = result.solution;
+    status = result.status;
+    nodes = result.nodes;
+    collected = requested;
+    return true;
+}
+
+void AsyncSolver::run() {
+    for (;;) {
+        Request job;
+        std::uint64_t generation;
+        {
+            std::unique_lock<std::mutex> lock(mutex);
+            wake.wait(lock, [this] { return stop || queued != 0; });
+            if (stop)
+                return;
+            job = request;
+            generation = queued;
+            queued = 0;
+            cancel = false;
+        }
+
+        SolveControl control;
+        control.deadline = std::chrono::steady_clock::now() + job.budget;
+        control.cancel = &cancel;
+        Board board = job.puzzle;
+        SolveStatus status;
+        std::uint64_t nodes;
+        if (job.backend == SolverBackend::DancingLinks) {
+            status = dlx.solve(board, control);
+            nodes = dlx.nodes;
+        }
+        else {
+            status = solver.load(board) ? solver.solve(board, control) : SolveStatus::Unsolvable;
+            nodes = solver.nodes;
+        }
+
+        // A cancelled search was replaced or discarded, nobody reads it
+        if (status == SolveStatus::Cancelled)
+            continue;
+        result = { board, status, nodes };
+        published.store(generation, std::memory_order_release);
+    }
+}
@@ -0,0 +1,238 @@
+#pragma once
+
+#include <cassert>
+#include <cstddef>
+#include <cstdint>
+#include <span>
+#include "Board.h"
+#include "Solver.h"
+#include "ThreadPool.h"
+
+#if defined(__SSE2__) || defined(_M_X64) || (defined(_M_IX86_FP) && _M_IX86_FP >= 2)
+#define SUDOKU_SSE2 1
+#include <emmintrin.h>
+#endif
+
+// Lock-step batch solver: kBatchLanes puzzles share every SIMD register, one
+// puzzle per 16-bit lane, and are propagated together with naked and hidden
+// singles. Lanes that propagation cannot finish drop out to the scalar Solver.
+constexpr int kBatchLanes = 8;
+
+// One 9-bit candidate mask per puzzle
+#if defined(SUDOKU_SSE2)
+struct LaneMasks
+{
+    __m128i v;
+};
+
+inline LaneMasks lanesSplat(std::uint16_t x) { return { _mm_set1_epi16(std::int16_t(x)) }; }
+inline LaneMasks operator&(LaneMasks a, LaneMasks b) { return { _mm_and_si128(a.v, b.v) }; }
+inline LaneMasks operator|(LaneMasks a, LaneMasks b) { return { _mm_or_si128(a.v, b.v) }; }
+// a & ~b
+inline LaneMasks andNot(LaneMasks a, LaneMasks b) { return { _mm_andnot_si128(b.v, a.v) }; }
+// All ones in lanes where x == 0
+inline LaneMasks isZero(LaneMasks x) { return { _mm_cmpeq_epi16(x.v, _mm_setzero_si128()) }; }
+inline LaneMasks minusOne(LaneMasks x) { return { _mm_sub_epi16(x.v, _mm_set1_epi16(1)) }; }
+inline bool anyLane(LaneMasks x) { return _mm_movemask_epi8(x.v) != 0; }
+inline std::uint16_t lane(LaneMasks x, int i) {
+    alignas(16) std::uint16_t lanes[kBatchLanes];
+    _mm_store_si128(reinterpret_cast<__m128i*>(lanes), x.v);
+    return lanes[i];
+}
+#else
+struct LaneMasks
+{
+    std::uint16_t v[kBatchLanes];
+};
+
+inline LaneMasks lanesSplat(std::uint16_t x) { LaneMasks r; for (auto& l : r.v) l = x; return r; }
+inline LaneMasks operator&(LaneMasks a, LaneMasks b) { for (int i = 0; i < kBatchLanes; ++i) a.v[i] &= b.v[i]; return a; }
+inline LaneMasks operator|(LaneMasks a, LaneMasks b) { for (int i = 0; i < kBatchLanes; ++i) a.v[i] |= b.v[i]; return a; }
+inline LaneMasks andNot(LaneMasks a, LaneMasks b) { for (int i = 0; i < kBatchLanes; ++i) a.v[i] &= ~b.v[i]; return a; }
+inline LaneMasks isZero(LaneMasks x) { for (auto& l : x.v) l = l == 0 ? 0xFFFF : 0; return x; }
+inline LaneMasks minusOne(LaneMasks x) { for (auto& l : x.v) --l; return x; }
+inline bool anyLane(LaneMasks x) { for (auto l : x.v) if (l) return true; return false; }
+inline std::uint16_t lane(LaneMasks x, int i) { return x.v[i]; }
+#endif
+
+// All ones in lanes where x holds exactly one digit
+inline LaneMasks isSingle(LaneMasks x) {
+    return andNot(isZero(x & minusOne(x)), isZero(x));
+}
+
+inline LaneMasks lanesNot(LaneMasks x) {
+    return andNot(lanesSplat(0xFFFF), x);
+}
+
+// lanes where mask is set take a, the others b
+inline LaneMasks select(LaneMasks mask, LaneMasks a, LaneMasks b) {
+    return (a & mask) | andNot(b, mask);
+}
+
+struct BatchStats
+{
+    std::size_t lockStep = 0;   // finished by lock-step propagation alone
+    std::size_t fallback = 0;   // needed the scalar search
+    std::size_t unsolvable = 0;
+};
+
+class BatchSolver
+{
+public:
+    // Solves count puzzles from a flat array of boards into solutions.
+    // solved[i] tells whether puzzle i has a solution.
+    BatchStats solve(const Board* puzzles, Board* solutions, bool* solved, std::size_t count);
+
+public:
+    Solver fallback;
+
+private:
+    // Runs naked and hidden singles to a fixed point, returns the lanes that
+    // hit a contradiction
+    LaneMasks propagate();
+    void solveGroup(const Board* puzzles, Board* solutions, bool* solved, int lanes, BatchStats& stats);
+
+    LaneMasks cand[9 * 9];
+    // Singles already eliminated from their peers
+    LaneMasks done[9 * 9];
+};
+
+LaneMasks BatchSolver::propagate() {
+    const LaneMasks all = lanesSplat(Solver::kAllDigits);
+    LaneMasks dead = lanesSplat(0);
+    bool changed = true;
+    while (changed) {
+        changed = false;
+
+        // Naked singles: remove each newly solved digit from the cell's peers
+        for (int cell = 0; cell < 9 * 9; ++cell) {
+            LaneMasks fresh = andNot(isSingle(cand[cell]), done[cell]);
+            if (!anyLane(fresh))
+                continue;
+            done[cell] = done[cell] | fresh;
+            LaneMasks digit = cand[cell] & fresh;
+            for (int peer : kPeers[cell])
+                cand[peer] = andNot(cand[peer], digit);
+            changed = true;
+        }
+
+        // Hidden singles: a digit with one possible cell in a unit goes there
+        for (const auto& unit : kUnits) {
+            LaneMasks once = lanesSplat(0), twice = lanesSplat(0);
+            for (int cell : unit) {
+                twice = twice | (once & cand[cell]);
+                once = once | cand[cell];
+            }
+            dead = dead | lanesNot(isZero(andNot(all, once)));
+            LaneMasks hidden = andNot(once, twice);
+            if (!anyLane(hidden))
+                continue;
+            for (int cell : unit) {
+                LaneMasks h = cand[cell] & hidden;
+                LaneMasks hit = lanesNot(isZero(h));
+                // Two hidden digits in one cell cannot both be placed
+                dead = dead | andNot(hit, isSingle(h));
+                LaneMasks narrowed = andNot(hit & isSingle(h), isSingle(cand[cell]));
+                if (!anyLane(narrowed))
+                    continue;
+                cand[cell] = select(narrowed, h, cand[cell]);
+                changed = true;
+            }
+        }
+
+        for (int cell = 0; cell < 9 * 9; ++cell)
+            dead = dead | isZero(cand[cell]);
+        // Dead lanes keep shrinking until they converge too, but stop early
+        // once every lane is dead
+        if (!anyLane(lanesNot(dead)))
+            break;
+    }
+    return dead;
+}
+
+void BatchSolver::solveGroup(const Board* puzzles, Board* solutions, bool* solved, int lanes, BatchStats& stats) {
+    for (int cell = 0; cell < 9 * 9; ++cell) {
+        alignas(16) std::uint16_t masks[kBatchLanes];
+        for (int l = 0; l < kBatchLanes; ++l) {
+            // Unused lanes get an already solved board so they never branch
+            int row = cell / 9, col = cell % 9;
+            int num = l < lanes ? puzzles[l][cell] : (row * 3 + row / 3 + col) % 9 + 1;
+            masks[l] = num == 0 ? Solver::kAllDigits : std::uint16_t(1 << (num - 1));
+        }
+#if defined(SUDOKU_SSE2)
+        cand[cell].v = _mm_load_si128(reinterpret_cast<const __m128i*>(masks));
+#else
+        for (int l = 0; l < kBatchLanes; ++l)
+            cand[cell].v[l] = masks[l];
+#endif
+        done[cell] = lanesSplat(0);
+    }
+
+    LaneMasks dead = propagate();
+    LaneMasks open = lanesSplat(0);
+    for (int cell = 0; cell < 9 * 9; ++cell)
+        open = open | lanesNot(isSingle(cand[cell]));
+
+    for (int l = 0; l < lanes; ++l) {
+        Board& board = solutions[l];
+        if (lane(dead, l)) {
+            solved[l] = false;
+            ++stats.unsolvable;
+            continue;
+        }
+        for (int cell = 0; cell < 9 * 9; ++cell) {
+            std::uint16_t mask = lane(cand[cell], l);
+            board[cell] = mask & (mask - 1) ? 0 : std::uint8_t(std::countr_zero(mask) + 1);
+        }
+        if (!lane(open, l)) {
+            solved[l] = true;
+            ++stats.lockStep;
+            continue;
+        }
+        // Continue from the propagated board rather than the original puzzle
+        solved[l] = fallback.load(board) && fallback.solve(board);
+        if (solved[l])
+            ++stats.fallback;
+        else
+            ++stats.unsolvable;
+    }
+}
+
+BatchStats BatchSolver::solve(const Board* puzzles, Board* solutions, bool* solved, std::size_t count) {
+    BatchStats stats;
+    fallback.branching = Solver::Branching::MostConstrained;
+    for (std::size_t i = 0; i < count; i += kBatchLanes) {
+        int lanes = count - i < kBatchLanes ? int(count - i) : kBatchLanes;
+        solveGroup(puzzles + i, solutions + i, solved + i, lanes, stats);
+    }
+    return stats;
+}
+
+// Solves puzzles[i] into solutions[i] on the pool, returns how many were
+// solved; an unsolvable puzzle gets an all-zero solution, and solutions must
+// be at least as long as puzzles. Work is split into lock-step groups, so an
+// expensive group only holds up the worker running it while the others steal
+// the rest.
+std::size_t solveBatch(std::span<const Board> puzzles, std::span<Board> solutions, ThreadPool& pool) {
+    assert(solutions.size() >= puzzles.size());
+    std::atomic<std::size_t> total{ 0 };
+    ThreadPool::Group group;
+    for (std::size_t first = 0; first < puzzles.size(); first += kBatchLanes) {
+        std::size_t count = std::min<std::size_t>(kBatchLanes, puzzles.size() - first);
+        pool.submit(group, [&, first, count] {
+            thread_local BatchSolver batch;
+            bool solved[kBatchLanes];
+            batch.solve(&puzzles[first], &solutions[first], solved, count);
+            std::size_t n = 0;
+            for (std::size_t i = 0; i < count; ++i) {
+                if (solved[i])
+                    ++n;
+                else
+                    solutions[first + i] = Board{};
+            }
+            total += n;
+        });
+    }
+    pool.wait(group);
+    return total;
+}
@@ -0,0 +1,112 @@
+#pragma once
+
+#include <array>
+#include <bit>
+#include <cstdint>
+#include <type_traits>
+
+// Flat row-major 9x9 board, 0 marks an empty cell
+using Board = std::array<std::uint8_t, 9 * 9>;
+// Snapshots, solver branches and thread handoffs copy boards with memcpy
+static_assert(sizeof(Board) == 9 * 9 && std::is_trivially_copyable_v<Board>);
+
+inline constexpr int boxOf(int row, int col) {
+    return row / 3 * 3 + col / 3;
+}
+
+// Occupancy of every row, column and box. Bit (num - 1) is set when num is
+// placed in that unit, so the candidates of a cell are one AND of three masks.
+struct UnitMasks
+{
+    static constexpr std::uint16_t kAllDigits = 0x1FF;
+
+    std::uint16_t rows[9]{}, cols[9]{}, boxes[9]{};
+
+    constexpr std::uint16_t candidates(int cell) const {
+        int row = cell / 9, col = cell % 9;
+        return ~(rows[row] | cols[col] | boxes[boxOf(row, col)]) & kAllDigits;
+    }
+    constexpr void add(int cell, int num) {
+        int row = cell / 9, col = cell % 9;
+        std::uint16_t bit = std::uint16_t(1 << (num - 1));
+        rows[row] |= bit;
+        cols[col] |= bit;
+        boxes[boxOf(row, col)] |= bit;
+    }
+    constexpr void erase(int cell, int num) {
+        int row = cell / 9, col = cell % 9;
+        std::uint16_t bit = std::uint16_t(~(1 << (num - 1)));
+        rows[row] &= bit;
+        cols[col] &= bit;
+        boxes[boxOf(row, col)] &= bit;
+    }
+};
+
+// Cells of the 27 units: the nine rows, then the nine columns, then the nine boxes
+inline constexpr std::array<std::array<std::uint8_t, 9>, 27> kUnits = [] {
+    std::array<std::array<std::uint8_t, 9>, 27> units{};
+    for (int i = 0; i < 9; ++i) {
+        for (int j = 0; j < 9; ++j) {
+            units[i][j] = std::uint8_t(i * 9 + j);
+            units[9 + i][j] = std::uint8_t(j * 9 + i);
+            units[18 + i][j] = std::uint8_t((i / 3 * 3 + j / 3) * 9 + i % 3 * 3 + j % 3);
+        }
+    }
+    return units;
+}();
+
+// The 20 cells sharing a row, column or box with each cell
+inline constexpr std::array<std::array<std::uint8_t, 20>, 9 * 9> kPeers = [] {
+    std::array<std::array<std::uint8_t, 20>, 9 * 9> peers{};
+    for (int cell = 0; cell < 9 * 9; ++cell) {
+        int row = cell / 9, col = cell % 9, n = 0;
+        for (int other = 0; other < 9 * 9; ++other) {
+            int r = other / 9, c = other % 9;
+            if (other != cell && (r == row || c == col || boxOf(r, c) == boxOf(row, col)))
+                peers[cell][n++] = std::uint8_t(other);
+        }
+    }
+    return peers;
+}();
+
+// Row, column and box unit of each cell, as indices into kUnits
+inline constexpr std::array<std::array<std::uint8_t, 3>, 9 * 9> kCellUnits = [] {
+    std::array<std::array<std::uint8_t, 3>, 9 * 9> units{};
+    for (int cell = 0; cell < 9 * 9; ++cell) {
+        int row = cell / 9, col = cell % 9;
+        units[cell] = { std::uint8_t(row), std::uint8_t(9 + col), std::uint8_t(18 + boxOf(row, col)) };
+    }
+    return units;
+}();
+
+// Set of cells as an 81-bit mask, cell i is bit i % 64 of words[i / 64]
+struct CellSet
+{
+    std::uint64_t words[2]{};
+
+    constexpr void set(int cell) { words[cell >> 6] |= std::uint64_t(1) << (cell & 63); }
+    constexpr void reset(int cell) { words[cell >> 6] &= ~(std::uint64_t(1) << (cell & 63)); }
+    constexpr bool test(int cell) const { return words[cell >> 6] >> (cell & 63) & 1; }
+    constexpr bool any() const { return (words[0] | words[1]) != 0; }
+    constexpr int count() const { return std::popcount(words[0]) + std::popcount(words[1]); }
+
+    friend constexpr CellSet operator&(CellSet a, CellSet b) { return { { a.words[0] & b.words[0], a.words[1] & b.words[1] } }; }
+    friend constexpr CellSet operator|(CellSet a, CellSet b) { return { { a.words[0] | b.words[0], a.words[1] | b.words[1] } }; }
+
+    // Calls f with every cell in the set, in increasing order
+    template <typename F>
+    void forEach(F&& f) const {
+        for (int w = 0; w < 2; ++w)
+            for (std::uint64_t bits = words[w]; bits; bits &= bits - 1)
+                f(w * 64 + std::countr_zero(bits));
+    }
+};
+
+// kPeers of each cell as a CellSet
+inline constexpr std::array<CellSet, 9 * 9> kPeerSets = [] {
+    std::array<CellSet, 9 * 9> sets{};
+    for (int cell = 0; cell < 9 * 9; ++cell)
+        for (int peer : kPeers[cell])
+            sets[cell].set(peer);
+    return sets;
+}();
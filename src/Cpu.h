@@ -0,0 +1,84 @@
+#pragma once
+
+#include <string>
+
+#if defined(__x86_64__) || defined(_M_X64) || defined(__i386__) || defined(_M_IX86)
+#define SUDOKU_X86 1
+#if defined(_MSC_VER)
+#include <intrin.h>
+#else
+#include <cpuid.h>
+#endif
+#endif
+
+// Instruction set extensions the solver kernels can use, probed with cpuid.
+// AVX and AVX-512 also need the OS to save their registers (XCR0).
+struct CpuFeatures
+{
+    bool sse41 = false;
+    bool avx2 = false;
+    bool avx512bw = false;
+};
+
+#if defined(SUDOKU_X86)
+void cpuid(int leaf, int subleaf, unsigned int regs[4]) {
+#if defined(_MSC_VER)
+    __cpuidex(reinterpret_cast<int*>(regs), leaf, subleaf);
+#else
+    __cpuid_count(leaf, subleaf, regs[0], regs[1], regs[2], regs[3]);
+#endif
+}
+
+unsigned long long xgetbv0() {
+#if defined(_MSC_VER)
+    return _xgetbv(0);
+#else
+    unsigned int eax, edx;
+    __asm__ volatile("xgetbv" : "=a"(eax), "=d"(edx) : "c"(0));
+    return (static_cast<unsigned long long>(edx) << 32) | eax;
+#endif
+}
+#endif
+
+CpuFeatures probeCpu() {
+    CpuFeatures features;
+#if defined(SUDOKU_X86)
+    unsigned int regs[4];
+    cpuid(0, 0, regs);
+    unsigned int maxLeaf = regs[0];
+    if (maxLeaf < 1)
+        return features;
+
+    cpuid(1, 0, regs);
+    features.sse41 = regs[2] & (1u << 19);
+    bool osxsave = regs[2] & (1u << 27);
+    bool avx = regs[2] & (1u << 28);
+    if (!osxsave || !avx || maxLeaf < 7)
+        return features;
+
+    unsigned long long xcr0 = xgetbv0();
+    bool ymm = (xcr0 & 0x6) == 0x6;      // XMM and YMM state
+    bool zmm = (xcr0 & 0xE6) == 0xE6;    // plus opmask and ZMM state
+    cpuid(7, 0, regs);
+    features.avx2 = ymm && (regs[1] & (1u << 5));
+    features.avx512bw = zmm && (regs[1] & (1u << 16)) && (regs[1] & (1u << 30));
+#endif
+    return features;
+}
+
+// Probed once, on first use
+const CpuFeatures& cpuFeatures() {
+    static const CpuFeatures features = probeCpu();
+    return features;
+}
+
+std::string describeCpu(const CpuFeatures& features) {
+    std::string str;
+    if (features.sse41) str += "sse4.1 ";
+    if (features.avx2) str += "avx2 ";
+    if (features.avx512bw) str += "avx512bw ";
+    if (str.empty())
+        return "baseline";
+    str.pop_back();
+    return str;
+}
@@ -0,0 +1,226 @@
+#pragma once
+
+#include <algorithm>
+#include <cstdint>
+#include <vector>
+#include "Board.h"
+#include "SolveControl.h"
+
+// Exact-cover solver (Knuth's Algorithm X with Dancing Links).
+// Columns are the 324 constraints: every cell holds a digit, and every row,
+// column and box holds each digit once. Each of the 729 (cell, digit)
+// placements is a matrix row covering exactly four of them.
+// The node pool is built once in the constructor and restored from a pristine
+// copy before every puzzle, so solving a batch never allocates.
+class DancingLinks
+{
+public:
+    static constexpr int kColumns = 4 * 9 * 9;
+    static constexpr int kRows = 9 * 9 * 9;
+    static constexpr int kNodes = 1 + kColumns + kRows * 4;
+
+    DancingLinks();
+
+    // Solves board in place, returns false if it has no solution
+    bool solve(Board& board);
+    // Same, but stops at the control's deadline or cancellation
+    SolveStatus solve(Board& board, const SolveControl& control);
+    // Counts solutions of board, stopping once `limit` are found
+    int countSolutions(const Board& board, int limit);
+
+public:
+    // Search nodes (rows tried) during the last solve
+    std::uint64_t nodes = 0;
+
+private:
+    struct Node
+    {
+        std::int16_t left, right, up, down, column, row;
+    };
+
+    void reset();
+    bool loadGivens(const Board& board);
+    void cover(int column);
+    void uncover(int column);
+    void selectRow(int node);
+    bool search();
+
+    std::vector<Node> pool, pristine;
+    std::vector<std::int16_t> sizes, pristineSizes;
+    std::vector<std::int16_t> solution;
+    int depth = 0;
+    int limit = 1, found = 0;
+    const SolveControl* control = nullptr;
+    std::uint64_t nextPoll = 0;
+    bool interrupted = false;
+    SolveStatus stopReason = SolveStatus::Solved;
+};
+
+DancingLinks::DancingLinks()
+    : pool(kNodes), sizes(1 + kColumns, 0), solution(9 * 9, 0)
+{
+    // Root and column headers form the circular header list
+    for (int i = 0; i <= kColumns; ++i) {
+        pool[i] = { std::int16_t(i == 0 ? kColumns : i - 1), std::int16_t(i == kColumns ? 0 : i + 1),
+                    std::int16_t(i), std::int16_t(i), std::int16_t(i), -1 };
+    }
+
+    for (int r = 0; r < kRows; ++r) {
+        int cell = r / 9, num = r % 9;
+        int row = cell / 9, col = cell % 9;
+        const int columns[4] = {
+            1 + cell,
+            1 + 81 + row * 9 + num,
+            1 + 162 + col * 9 + num,
+            1 + 243 + boxOf(row, col) * 9 + num
+        };
+
+        int first = 1 + kColumns + r * 4;
+        for (int k = 0; k < 4; ++k) {
+            int n = first + k, c = columns[k];
+            Node& node = pool[n];
+            node.left = std::int16_t(first + (k + 3) % 4);
+            node.right = std::int16_t(first + (k + 1) % 4);
+            node.column = std::int16_t(c);
+            node.row = std::int16_t(r);
+            // Append to the bottom of the column
+            node.up = pool[c].up;
+            node.down = std::int16_t(c);
+            pool[pool[c].up].down = std::int16_t(n);
+            pool[c].up = std::int16_t(n);
+            ++sizes[c];
+        }
+    }
+
+    pristine = pool;
+    pristineSizes = sizes;
+}
+
+void DancingLinks::reset() {
+    std::copy(pristine.begin(), pristine.end(), pool.begin());
+    std::copy(pristineSizes.begin(), pristineSizes.end(), sizes.begin());
+    depth = 0;
+}
+
+void DancingLinks::cover(int column) {
+    Node* p = pool.data();
+    p[p[column].right].left = p[column].left;
+    p[p[column].left].right = p[column].right;
+    for (int i = p[column].down; i != column; i = p[i].down) {
+        for (int j = p[i].right; j != i; j = p[j].right) {
+            p[p[j].down].up = p[j].up;
+            p[p[j].up].down = p[j].down;
+            --sizes[p[j].column];
+        }
+    }
+}
+
+void DancingLinks::uncover(int column) {
+    Node* p = pool.data();
+    for (int i = p[column].up; i != column; i = p[i].up) {
+        for (int j = p[i].left; j != i; j = p[j].left) {
+            ++sizes[p[j].column];
+            p[p[j].down].up = std::int16_t(j);
+            p[p[j].up].down = std::int16_t(j);
+        }
+    }
+    p[p[column].right].left = std::int16_t(column);
+    p[p[column].left].right = std::int16_t(column);
+}
+
+void DancingLinks::selectRow(int node) {
+    for (int j = pool[node].right; j != node; j = pool[j].right)
+        cover(pool[j].column);
+}
+
+// Givens are selected up front; a given whose constraints are already covered
+// conflicts with an earlier one
+bool DancingLinks::loadGivens(const Board& board) {
+    for (int cell = 0; cell < 9 * 9; ++cell) {
+        if (board[cell] == 0)
+            continue;
+        int first = 1 + kColumns + (cell * 9 + board[cell] - 1) * 4;
+        for (int k = 0; k < 4; ++k) {
+            int column = pool[first + k].column;
+            // A covered column has been unlinked from the header list
+            if (pool[pool[column].left].right != column)
+                return false;
+        }
+        cover(pool[first].column);
+        selectRow(first);
+        solution[depth++] = pool[first].row;
+    }
+    return true;
+}
+
+// Returns true once the solution limit is reached
+bool DancingLinks::search() {
+    if (control && nodes >= nextPoll) {
+        nextPoll = nodes + control->interval;
+        if (control->shouldStop(nodes, depth, stopReason)) {
+            interrupted = true;
+            return true;
+        }
+    }
+
+    Node* p = pool.data();
+    if (p[0].right == 0)
+        return ++found >= limit;
+
+    // Branch on the constraint with the fewest remaining options
+    int column = p[0].right;
+    for (int c = p[column].right; c != 0; c = p[c].right)
+        if (sizes[c] < sizes[column])
+            column = c;
+    if (sizes[column] == 0)
+        return false;
+
+    cover(column);
+    for (int r = p[column].down; r != column; r = p[r].down) {
+        ++nodes;
+        solution[depth++] = p[r].row;
+        selectRow(r);
+        if (search())
+            return true;
+        for (int j = p[r].left; j != r; j = p[j].left)
+            uncover(p[j].column);
+        --depth;
+    }
+    uncover(column);
+    return false;
+}
+
+bool DancingLinks::solve(Board& board) {
+    reset();
+    nodes = 0;
+    limit = 1;
+    found = 0;
+    interrupted = false;
+    nextPoll = 0;
+    if (!loadGivens(board) || !search() || interrupted)
+        return false;
+    for (int i = 0; i < depth; ++i)
+        board[solution[i] / 9] = solution[i] % 9 + 1;
+    return true;
+}
+
+SolveStatus DancingLinks::solve(Board& board, const SolveControl& control) {
+    this->control = &control;
+    bool solved = solve(board);
+    this->control = nullptr;
+    if (interrupted)
+        return stopReason;
+    return solved ? SolveStatus::Solved : SolveStatus::Unsolvable;
+}
+
+int DancingLinks::countSolutions(const Board& board, int limit) {
+    reset();
+    nodes = 0;
+    this->limit = limit;
+    found = 0;
+    interrupted = false;
+    if (!loadGivens(board))
+        return 0;
+    search();
+    return found;
+}
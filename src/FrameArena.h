@@ -0,0 +1,52 @@
+#pragma once
+
+#include <cassert>
+#include <cstdarg>
+#include <cstddef>
+#include <cstdint>
+#include <cstdio>
+
+// Bump allocator for data that only lives for one frame, such as ImGui window
+// names and labels. Allocation is a pointer bump, and reset at the start of
+// the next frame releases everything at once without touching the heap.
+class FrameArena
+{
+public:
+    static constexpr std::size_t kCapacity = 16 * 1024;
+
+    // printf into the arena, the string stays valid until the next reset.
+    // Running out of room asserts; release builds get "?" instead.
+    const char* format(const char* fmt, ...);
+    void reset();
+
+public:
+    // Most bytes used by a single frame so far, ~App logs it in debug builds
+    std::size_t highWater = 0;
+
+private:
+    alignas(std::max_align_t) char buffer[kCapacity];
+    std::size_t used = 0;
+};
+
+const char* FrameArena::format(const char* fmt, ...) {
+    char* str = buffer + used;
+    std::size_t room = kCapacity - used;
+    va_list args;
+    va_start(args, fmt);
+    int length = std::vsnprintf(str, room, fmt, args);
+    va_end(args);
+    if (length < 0 || std::size_t(length) >= room) {
+        // Every overflowing label would be the same "?", so ImGui would merge
+        // the windows they name; raise kCapacity rather than rely on this
+        assert(!"frame arena overflow");
+        return "?";
+    }
+    used += length + 1;
+    return str;
+}
+
+void FrameArena::reset() {
+    if (used > highWater)
+        highWater = used;
+    used = 0;
+}
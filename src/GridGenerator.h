@@ -0,0 +1,115 @@
+#pragma once
+
+#include <bit>
+#include <cstdint>
+#include <iterator>
+#include "Board.h"
+#include "Random.h"
+#include "Symmetry.h"
+
+// Random complete solution grids, uniformly distributed over all of them.
+// A proposal fills the three diagonal boxes, which share no unit, with random
+// permutations and completes the rest most-constrained cell first with random
+// candidates and no backtracking. That favours grids with few choices on the
+// way, by exactly the product w of the candidate counts, so the proposals
+// drive an independence Metropolis-Hastings chain: a proposal replaces the
+// current grid with probability min(1, w' / w), which leaves the chain's
+// distribution uniform. The output is the current grid under a random
+// symmetry, so a grid kept for several calls never repeats verbatim.
+class GridGenerator
+{
+public:
+    // Proposals a fresh chain takes before its first grid
+    static constexpr int kBurnIn = 8;
+
+    // Fills board with a random valid complete grid drawn from rng
+    void generate(Board& board, Rng& rng);
+    // Drops the chain, so the next grid depends on rng alone. Its burn-in is
+    // short, so a restarted chain is only close to uniform.
+    void restart() { warm = false; }
+
+public:
+    // Placements made by the last generate, dead-end proposals included
+    std::uint64_t nodes = 0;
+    // Over the generator's lifetime
+    std::uint64_t proposals = 0, accepted = 0;
+
+private:
+    // One proposal into cells with its weight, false at a dead end
+    bool propose(Rng& rng, double& weight);
+    void place(int cell, int num);
+    // One uniformly chosen digit of mask
+    static int pickDigit(std::uint16_t mask, Rng& rng);
+
+    Board cells{};
+    UnitMasks units;
+    // State of the chain
+    Board current{};
+    double currentWeight = 0;
+    bool warm = false;
+};
+
+void GridGenerator::place(int cell, int num) {
+    units.add(cell, num);
+    cells[cell] = std::uint8_t(num);
+}
+
+int GridGenerator::pickDigit(std::uint16_t mask, Rng& rng) {
+    int skip = int(rng.bounded(std::popcount(mask)));
+    for (; skip > 0; --skip)
+        mask &= mask - 1;
+    return std::countr_zero(mask) + 1;
+}
+
+bool GridGenerator::propose(Rng& rng, double& weight) {
+    cells = {};
+    units = {};
+    int digits[9] = { 1, 2, 3, 4, 5, 6, 7, 8, 9 };
+    for (int box : { 0, 4, 8 }) {
+        rng.shuffle(std::begin(digits), std::end(digits));
+        for (int i = 0; i < 9; ++i)
+            place((box / 3 * 3 + i / 3) * 9 + box % 3 * 3 + i % 3, digits[i]);
+    }
+
+    // At most 9^54, well inside a double
+    weight = 1;
+    for (;;) {
+        int cell = -1, best = 10;
+        std::uint16_t mask = 0;
+        for (int i = 0; i < 9 * 9 && best > 1; ++i) {
+            if (cells[i])
+                continue;
+            std::uint16_t m = units.candidates(i);
+            int count = std::popcount(m);
+            if (count < best) {
+                cell = i;
+                best = count;
+                mask = m;
+            }
+        }
+        if (cell < 0)
+            return true;
+        if (best == 0)
+            return false;
+        weight *= best;
+        place(cell, pickDigit(mask, rng));
+        ++nodes;
+    }
+}
+
+void GridGenerator::generate(Board& board, Rng& rng) {
+    nodes = 0;
+    for (int step = warm ? 1 : kBurnIn; step > 0; --step) {
+        double weight;
+        while (!propose(rng, weight)) {}
+        ++proposals;
+        // A fresh chain starts at its first proposal
+        if (!warm || rng.unit() * currentWeight < weight) {
+            current = cells;
+            currentWeight = weight;
+            warm = true;
+            ++accepted;
+        }
+    }
+    GridTransform::random(rng).apply(current, board);
+}
@@ -0,0 +1,275 @@
+#pragma once
+
+#include <array>
+#include <cstdint>
+#include <cstring>
+#include "Board.h"
+#include "Cpu.h"
+
+#if defined(SUDOKU_X86)
+#include <immintrin.h>
+// Kernels are compiled for their own instruction set and bound at startup
+// from the cpuid probe, so one binary runs on every x86 machine
+#if defined(__GNUC__) || defined(__clang__)
+#define SUDOKU_TARGET(isa) __attribute__((target(isa)))
+#else
+#define SUDOKU_TARGET(isa)
+#endif
+#endif
+
+// Candidate masks for all 81 cells in one pass. The lanes are padded so the
+// widest kernel never reads past the end of its tables.
+constexpr int kScanLanes = 128;
+
+struct CandidateScan
+{
+    // Candidate mask per cell, 0 for filled cells and padding
+    alignas(64) std::uint16_t masks[kScanLanes];
+    // Bit i is set when cell i has exactly one candidate left
+    std::uint64_t singles[2];
+    // Some empty cell has no candidates left
+    bool contradiction;
+};
+
+// Row, column and box of every lane; padding lanes use 0x80, which makes
+// a byte shuffle return zero
+alignas(64) inline constexpr std::array<std::array<std::uint8_t, kScanLanes>, 3> kLaneUnits = [] {
+    std::array<std::array<std::uint8_t, kScanLanes>, 3> t{};
+    for (int i = 0; i < kScanLanes; ++i) {
+        bool cell = i < 9 * 9;
+        t[0][i] = cell ? std::uint8_t(i / 9) : 0x80;
+        t[1][i] = cell ? std::uint8_t(i % 9) : 0x80;
+        t[2][i] = cell ? std::uint8_t(boxOf(i / 9, i % 9)) : 0x80;
+    }
+    return t;
+}();
+
+void scanCandidatesScalar(const Board& cells, const std::uint16_t rows[9], const std::uint16_t cols[9], const std::uint16_t boxes[9], CandidateScan& out) {
+    out.singles[0] = out.singles[1] = 0;
+    out.contradiction = false;
+    for (int i = 0; i < kScanLanes; ++i) {
+        if (i >= 9 * 9 || cells[i] != 0) {
+            out.masks[i] = 0;
+            continue;
+        }
+        int row = i / 9, col = i % 9;
+        std::uint16_t mask = ~(rows[row] | cols[col] | boxes[boxOf(row, col)]) & UnitMasks::kAllDigits;
+        out.masks[i] = mask;
+        if (mask == 0)
+            out.contradiction = true;
+        else if (!(mask & (mask - 1)))
+            out.singles[i / 64] |= std::uint64_t(1) << (i % 64);
+    }
+}
+
+#if defined(SUDOKU_X86)
+// The 9-bit unit masks are split into a low byte and a high bit, so each fits
+// a 16-entry byte table and can be gathered for 16 cells with one pshufb.
+// Interleaving the two halves again yields the masks in 16-bit lanes.
+struct ScanTables
+{
+    alignas(64) std::uint8_t cells[kScanLanes];
+    alignas(16) std::uint8_t lo[3][16];
+    alignas(16) std::uint8_t hi[3][16];
+
+    ScanTables(const Board& board, const std::uint16_t rows[9], const std::uint16_t cols[9], const std::uint16_t boxes[9]) {
+        std::memset(cells, 0xFF, sizeof(cells));
+        std::memcpy(cells, board.data(), board.size());
+        std::memset(lo, 0, sizeof(lo));
+        std::memset(hi, 0, sizeof(hi));
+        const std::uint16_t* units[3] = { rows, cols, boxes };
+        for (int u = 0; u < 3; ++u) {
+            for (int i = 0; i < 9; ++i) {
+                lo[u][i] = std::uint8_t(units[u][i]);
+                hi[u][i] = std::uint8_t(units[u][i] >> 8);
+            }
+        }
+    }
+};
+
+SUDOKU_TARGET("sse4.1")
+void scanCandidatesSse41(const Board& board, const std::uint16_t rows[9], const std::uint16_t cols[9], const std::uint16_t boxes[9], CandidateScan& out) {
+    ScanTables t(board, rows, cols, boxes);
+    const __m128i zero = _mm_setzero_si128();
+    const __m128i one = _mm_set1_epi16(1);
+    const __m128i all = _mm_set1_epi16(UnitMasks::kAllDigits);
+    __m128i lo[3], hi[3];
+    for (int u = 0; u < 3; ++u) {
+        lo[u] = _mm_load_si128(reinterpret_cast<const __m128i*>(t.lo[u]));
+        hi[u] = _mm_load_si128(reinterpret_cast<const __m128i*>(t.hi[u]));
+    }
+
+    out.singles[0] = out.singles[1] = 0;
+    __m128i dead = zero;
+    for (int base = 0; base < 9 * 9; base += 16) {
+        __m128i usedLo = zero, usedHi = zero;
+        for (int u = 0; u < 3; ++u) {
+            __m128i index = _mm_load_si128(reinterpret_cast<const __m128i*>(&kLaneUnits[u][base]));
+            usedLo = _mm_or_si128(usedLo, _mm_shuffle_epi8(lo[u], index));
+            usedHi = _mm_or_si128(usedHi, _mm_shuffle_epi8(hi[u], index));
+        }
+        __m128i emptyBytes = _mm_cmpeq_epi8(_mm_load_si128(reinterpret_cast<const __m128i*>(&t.cells[base])), zero);
+        __m128i used[2] = { _mm_unpacklo_epi8(usedLo, usedHi), _mm_unpackhi_epi8(usedLo, usedHi) };
+        __m128i empty[2] = { _mm_cvtepi8_epi16(emptyBytes), _mm_cvtepi8_epi16(_mm_srli_si128(emptyBytes, 8)) };
+
+        __m128i single[2];
+        for (int h = 0; h < 2; ++h) {
+            __m128i cand = _mm_and_si128(_mm_andnot_si128(used[h], all), empty[h]);
+            _mm_store_si128(reinterpret_cast<__m128i*>(&out.masks[base + h * 8]), cand);
+            __m128i none = _mm_cmpeq_epi16(cand, zero);
+            __m128i pow2 = _mm_cmpeq_epi16(_mm_and_si128(cand, _mm_sub_epi16(cand, one)), zero);
+            single[h] = _mm_andnot_si128(none, pow2);
+            dead = _mm_or_si128(dead, _mm_and_si128(none, empty[h]));
+        }
+        std::uint64_t bits = std::uint16_t(_mm_movemask_epi8(_mm_packs_epi16(single[0], single[1])));
+        out.singles[base / 64] |= bits << (base % 64);
+    }
+    for (int i = 96; i < kScanLanes; i += 8)
+        _mm_store_si128(reinterpret_cast<__m128i*>(&out.masks[i]), zero);
+    out.contradiction = !_mm_testz_si128(dead, dead);
+}
+
+SUDOKU_TARGET("avx2")
+void scanCandidatesAvx2(const Board& board, const std::uint16_t rows[9], const std::uint16_t cols[9], const std::uint16_t boxes[9], CandidateScan& out) {
+    ScanTables t(board, rows, cols, boxes);
+    const __m256i zero = _mm256_setzero_si256();
+    const __m256i one = _mm256_set1_epi16(1);
+    const __m256i all = _mm256_set1_epi16(UnitMasks::kAllDigits);
+    __m256i lo[3], hi[3];
+    for (int u = 0; u < 3; ++u) {
+        lo[u] = _mm256_broadcastsi128_si256(_mm_load_si128(reinterpret_cast<const __m128i*>(t.lo[u])));
+        hi[u] = _mm256_broadcastsi128_si256(_mm_load_si128(reinterpret_cast<const __m128i*>(t.hi[u])));
+    }
+
+    out.singles[0] = out.singles[1] = 0;
+    __m256i dead = zero;
+    for (int base = 0; base < 9 * 9; base += 32) {
+        __m256i usedLo = zero, usedHi = zero;
+        for (int u = 0; u < 3; ++u) {
+            __m256i index = _mm256_load_si256(reinterpret_cast<const __m256i*>(&kLaneUnits[u][base]));
+            usedLo = _mm256_or_si256(usedLo, _mm256_shuffle_epi8(lo[u], index));
+            usedHi = _mm256_or_si256(usedHi, _mm256_shuffle_epi8(hi[u], index));
+        }
+        __m256i emptyBytes = _mm256_cmpeq_epi8(_mm256_load_si256(reinterpret_cast<const __m256i*>(&t.cells[base])), zero);
+        // Byte unpacks work within 128-bit halves, swap the middle quarters back
+        __m256i usedA = _mm256_unpacklo_epi8(usedLo, usedHi);
+        __m256i usedB = _mm256_unpackhi_epi8(usedLo, usedHi);
+        __m256i used[2] = { _mm256_permute2x128_si256(usedA, usedB, 0x20), _mm256_permute2x128_si256(usedA, usedB, 0x31) };
+        __m256i empty[2] = { _mm256_cvtepi8_epi16(_mm256_castsi256_si128(emptyBytes)), _mm256_cvtepi8_epi16(_mm256_extracti128_si256(emptyBytes, 1)) };
+
+        __m256i single[2];
+        for (int h = 0; h < 2; ++h) {
+            __m256i cand = _mm256_and_si256(_mm256_andnot_si256(used[h], all), empty[h]);
+            _mm256_store_si256(reinterpret_cast<__m256i*>(&out.masks[base + h * 16]), cand);
+            __m256i none = _mm256_cmpeq_epi16(cand, zero);
+            __m256i pow2 = _mm256_cmpeq_epi16(_mm256_and_si256(cand, _mm256_sub_epi16(cand, one)), zero);
+            single[h] = _mm256_andnot_si256(none, pow2);
+            dead = _mm256_or_si256(dead, _mm256_and_si256(none, empty[h]));
+        }
+        __m256i packed = _mm256_permute4x64_epi64(_mm256_packs_epi16(single[0], single[1]), 0xD8);
+        std::uint64_t bits = std::uint32_t(_mm256_movemask_epi8(packed));
+        out.singles[base / 64] |= bits << (base % 64);
+    }
+    _mm256_store_si256(reinterpret_cast<__m256i*>(&out.masks[96]), zero);
+    _mm256_store_si256(reinterpret_cast<__m256i*>(&out.masks[112]), zero);
+    out.contradiction = !_mm256_testz_si256(dead, dead);
+}
+
+SUDOKU_TARGET("avx2,avx512f,avx512bw")
+void scanCandidatesAvx512(const Board& board, const std::uint16_t rows[9], const std::uint16_t cols[9], const std::uint16_t boxes[9], CandidateScan& out) {
+    ScanTables t(board, rows, cols, boxes);
+    const __m512i zero = _mm512_setzero_si512();
+    const __m512i one = _mm512_set1_epi16(1);
+    const __m512i all = _mm512_set1_epi16(UnitMasks::kAllDigits);
+    // Undo the per-128-bit interleave of the byte unpacks
+    const __m512i firstHalf = _mm512_setr_epi64(0, 1, 8, 9, 2, 3, 10, 11);
+    const __m512i secondHalf = _mm512_setr_epi64(4, 5, 12, 13, 6, 7, 14, 15);
+    __m512i lo[3], hi[3];
+    for (int u = 0; u < 3; ++u) {
+        lo[u] = _mm512_broadcast_i32x4(_mm_load_si128(reinterpret_cast<const __m128i*>(t.lo[u])));
+        hi[u] = _mm512_broadcast_i32x4(_mm_load_si128(reinterpret_cast<const __m128i*>(t.hi[u])));
+    }
+
+    out.singles[0] = out.singles[1] = 0;
+    bool dead = false;
+    for (int base = 0; base < kScanLanes; base += 64) {
+        __m512i usedLo = zero, usedHi = zero;
+        for (int u = 0; u < 3; ++u) {
+            __m512i index = _mm512_load_si512(&kLaneUnits[u][base]);
+            usedLo = _mm512_or_si512(usedLo, _mm512_shuffle_epi8(lo[u], index));
+            usedHi = _mm512_or_si512(usedHi, _mm512_shuffle_epi8(hi[u], index));
+        }
+        __mmask64 emptyBits = _mm512_cmpeq_epi8_mask(_mm512_load_si512(&t.cells[base]), zero);
+        __m512i usedA = _mm512_unpacklo_epi8(usedLo, usedHi);
+        __m512i usedB = _mm512_unpackhi_epi8(usedLo, usedHi);
+        __m512i used[2] = { _mm512_permutex2var_epi64(usedA, firstHalf, usedB), _mm512_permutex2var_epi64(usedA, secondHalf, usedB) };
+
+        for (int h = 0; h < 2; ++h) {
+            __mmask32 empty = static_cast<__mmask32>(emptyBits >> (h * 32));
+            __m512i cand = _mm512_maskz_mov_epi16(empty, _mm512_andnot_si512(used[h], all));
+            _mm512_store_si512(&out.masks[base + h * 32], cand);
+            __mmask32 none = _mm512_cmpeq_epi16_mask(cand, zero);
+            __mmask32 pow2 = _mm512_cmpeq_epi16_mask(_mm512_and_si512(cand, _mm512_sub_epi16(cand, one)), zero);
+            out.singles[base / 64] |= std::uint64_t(pow2 & ~none) << (h * 32);
+            dead |= (none & empty) != 0;
+        }
+    }
+    out.contradiction = dead;
+}
+#endif
+
+using ScanKernel = void (*)(const Board&, const std::uint16_t[9], const std::uint16_t[9], const std::uint16_t[9], CandidateScan&);
+
+enum class KernelLevel
+{
+    Scalar, Sse41, Avx2, Avx512
+};
+
+const char* kernelName(KernelLevel level) {
+    const char* names[] = { "scalar", "sse4.1", "avx2", "avx512" };
+    return names[static_cast<int>(level)];
+}
+
+bool kernelSupported(KernelLevel level, const CpuFeatures& features) {
+    switch (level) {
+    case KernelLevel::Sse41: return features.sse41;
+    case KernelLevel::Avx2: return features.avx2;
+    case KernelLevel::Avx512: return features.avx512bw;
+    default: return true;
+    }
+}
+
+KernelLevel bestKernelLevel(const CpuFeatures& features) {
+    if (features.avx512bw) return KernelLevel::Avx512;
+    if (features.avx2) return KernelLevel::Avx2;
+    if (features.sse41) return KernelLevel::Sse41;
+    return KernelLevel::Scalar;
+}
+
+ScanKernel scanKernel(KernelLevel level) {
+#if defined(SUDOKU_X86)
+    switch (level) {
+    case KernelLevel::Sse41: return scanCandidatesSse41;
+    case KernelLevel::Avx2: return scanCandidatesAvx2;
+    case KernelLevel::Avx512: return scanCandidatesAvx512;
+    default: break;
+    }
+#endif
+    return scanCandidatesScalar;
+}
+
+// Bound once at startup from the cpuid probe
+inline KernelLevel activeKernelLevel = bestKernelLevel(cpuFeatures());
+inline ScanKernel activeScanKernel = scanKernel(activeKernelLevel);
+
+// Rebinds the kernel, used by the benchmark to compare levels. Not thread safe.
+void bindKernel(KernelLevel level) {
+    if (!kernelSupported(level, cpuFeatures()))
+        level = bestKernelLevel(cpuFeatures());
+    activeKernelLevel = level;
+    activeScanKernel = scanKernel(level);
+}
+
+void scanCandidates(const Board& cells, const std::uint16_t rows[9], const std::uint16_t cols[9], const std::uint16_t boxes[9], CandidateScan& out) {
+    activeScanKernel(cells, rows, cols, boxes, out);
+}
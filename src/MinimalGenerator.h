@@ -0,0 +1,129 @@
+#pragma once
+
+#include <algorithm>
+#include <atomic>
+#include <cstdint>
+#include <mutex>
+#include <numeric>
+#include "Board.h"
+#include "GridGenerator.h"
+#include "Random.h"
+#include "Solver.h"
+#include "ThreadPool.h"
+
+// Minimal puzzles: removing any remaining clue makes the solution ambiguous.
+// One greedy pass over a removal order already gives a minimal puzzle, since
+// a clue that was needed stays needed as more clues go. The clue count it
+// ends at depends on the order, so several orders of the same grid are
+// searched in parallel and the fewest clues win. An order gives up as soon
+// as the clues it had to keep exceed the best so far, and all of them stop
+// once one reaches the target.
+class MinimalGenerator
+{
+public:
+    struct Options
+    {
+        int targetClues = 22;
+        // Removal orders tried per grid, 0 means four per pool thread
+        int ordersPerGrid = 0;
+        // Fresh grids tried before settling for the best found
+        int maxGrids = 8;
+    };
+
+    struct Stats
+    {
+        std::uint64_t grids = 0;
+        std::uint64_t orders = 0;
+        // Orders stopped early, either pruned or after the target was met
+        std::uint64_t abandoned = 0;
+        std::uint64_t solverCalls = 0;
+    };
+
+    // Writes the minimal puzzle with the fewest clues found to puzzle,
+    // returns true when it meets the target
+    bool generate(Board& puzzle, Rng& rng, ThreadPool& pool);
+
+public:
+    Options options;
+    // Accumulated over every generate call
+    Stats stats;
+
+private:
+    struct Search
+    {
+        std::atomic<int> bestClues{ 9 * 9 + 1 };
+        std::atomic<bool> done{ false };
+        std::mutex mutex;
+        Board best{};
+    };
+
+    // One greedy removal pass, returns the clues left or 0 when it gave up.
+    // The best puzzle is kept across grids, so later grids only count if
+    // they beat it.
+    static int removeInOrder(const Board& grid, std::uint64_t seed, Search& search, std::uint64_t& calls);
+    GridGenerator grids;
+};
+
+int MinimalGenerator::removeInOrder(const Board& grid, std::uint64_t seed, Search& search, std::uint64_t& calls) {
+    thread_local Solver solver;
+    solver.branching = Solver::Branching::MostConstrained;
+    solver.load(grid);
+
+    Rng rng(seed);
+    int order[9 * 9];
+    std::iota(std::begin(order), std::end(order), 0);
+    rng.shuffle(std::begin(order), std::end(order));
+
+    int kept = 0;
+    for (int cell : order) {
+        if (search.done.load(std::memory_order_relaxed))
+            return 0;
+        int num = solver.board()[cell];
+        solver.remove(cell);
+        ++calls;
+        if (solver.countSolutions(2) != 1) {
+            solver.place(cell, num);
+            // Kept clues are final, this order cannot beat the best any more
+            if (++kept >= search.bestClues.load(std::memory_order_relaxed))
+                return 0;
+        }
+    }
+
+    std::lock_guard<std::mutex> lock(search.mutex);
+    if (kept < search.bestClues) {
+        search.bestClues = kept;
+        search.best = solver.board();
+    }
+    return kept;
+}
+
+bool MinimalGenerator::generate(Board& puzzle, Rng& rng, ThreadPool& pool) {
+    int orders = options.ordersPerGrid > 0 ? options.ordersPerGrid : 4 * int(pool.size());
+    Search search;
+    for (int g = 0; g < std::max(options.maxGrids, 1) && !search.done; ++g) {
+        Board grid;
+        grids.generate(grid, rng);
+        ++stats.grids;
+
+        std::atomic<std::uint64_t> calls{ 0 }, abandoned{ 0 };
+        ThreadPool::Group group;
+        for (int i = 0; i < orders; ++i) {
+            std::uint64_t seed = rng();
+            pool.submit(group, [&, seed] {
+                std::uint64_t taskCalls = 0;
+                int clues = removeInOrder(grid, seed, search, taskCalls);
+                calls += taskCalls;
+                if (clues == 0)
+                    ++abandoned;
+                else if (clues <= options.targetClues)
+                    search.done = true;
+            });
+        }
+        pool.wait(group);
+        stats.orders += orders;
+        stats.abandoned += abandoned;
+        stats.solverCalls += calls;
+    }
+    puzzle = search.best;
+    return search.done;
+}
@@ -0,0 +1,187 @@
+#pragma once
+
+#include <algorithm>
+#include <atomic>
+#include <chrono>
+#include <condition_variable>
+#include <cstdint>
+#include <memory>
+#include <mutex>
+#include <thread>
+#include <vector>
+#include "Board.h"
+#include "Sudoku.h"
+#include "ThreadPool.h"
+
+// Keeps a bounded queue of ready puzzles for each difficulty level so a new
+// game is a pop instead of a generate. Worker threads, each with its own
+// Sudoku, refill whichever level is emptiest and sleep once all are full.
+class PuzzleCache
+{
+public:
+    static constexpr int kLevels = 4;
+
+    struct Config
+    {
+        // Puzzles kept ready per level
+        int depth = 4;
+        int workers = 1;
+        // Pause of a worker after each puzzle, throttles the refill rate
+        std::chrono::milliseconds refillInterval{ 0 };
+        // Evil puzzles are minimal ones with at most this many clues, 0 keeps
+        // the plain clue-count generator
+        int minimalEvilClues = 0;
+        // Clue pattern of every generated puzzle; minimal Evil puzzles are
+        // only used without one
+        ClueSymmetry symmetry = ClueSymmetry::None;
+    };
+
+    PuzzleCache() : PuzzleCache(Config{}) {}
+    explicit PuzzleCache(const Config& config);
+    ~PuzzleCache();
+
+    // Takes a ready puzzle of the given level, false on a miss
+    bool pop(int level, Board& puzzle);
+    int ready(int level);
+    // Drops every ready puzzle and refills with the new pattern
+    void setSymmetry(ClueSymmetry symmetry);
+
+public:
+    std::atomic<std::uint64_t> hits{ 0 }, misses{ 0 };
+
+private:
+    // Ring buffer of `depth` puzzles
+    struct Queue
+    {
+        std::vector<Board> puzzles;
+        int head = 0, count = 0;
+    };
+
+    void run();
+    // Level with the fewest ready puzzles, -1 when every queue is full
+    int neediest() const;
+
+    Config config;
+    std::mutex mutex;
+    std::condition_variable wake;
+    Queue queues[kLevels];
+    // Puzzles being generated for each level, so workers do not overfill it
+    int inFlight[kLevels]{};
+    // Bumped by setSymmetry, puzzles started before it are thrown away
+    std::uint64_t epoch = 0;
+    bool stop = false;
+    // Searches removal orders for minimal Evil puzzles
+    std::unique_ptr<ThreadPool> minimalPool;
+    std::vector<std::thread> workers;
+};
+
+PuzzleCache::PuzzleCache(const Config& config)
+    : config(config)
+{
+    this->config.depth = std::max(this->config.depth, 1);
+    for (Queue& queue : queues)
+        queue.puzzles.resize(this->config.depth);
+    if (this->config.minimalEvilClues > 0)
+        minimalPool = std::make_unique<ThreadPool>();
+    for (int i = 0; i < this->config.workers; ++i)
+        workers.emplace_back(&PuzzleCache::run, this);
+}
+
+PuzzleCache::~PuzzleCache() {
+    {
+        std::lock_guard<std::mutex> lock(mutex);
+        stop = true;
+    }
+    wake.notify_all();
+    for (std::thread& worker : workers)
+        worker.join();
+}
+
+bool PuzzleCache::pop(int level, Board& puzzle) {
+    {
+        std::lock_guard<std::mutex> lock(mutex);
+        Queue& queue = queues[level];
+        if (queue.count == 0) {
+            ++misses;
+            return false;
+        }
+        puzzle = queue.puzzles[queue.head];
+        queue.head = (queue.head + 1) % config.depth;
+        --queue.count;
+        ++hits;
+    }
+    wake.notify_one();
+    return true;
+}
+
+int PuzzleCache::ready(int level) {
+    std::lock_guard<std::mutex> lock(mutex);
+    return queues[level].count;
+}
+
+void PuzzleCache::setSymmetry(ClueSymmetry symmetry) {
+    {
+        std::lock_guard<std::mutex> lock(mutex);
+        if (config.symmetry == symmetry)
+            return;
+        config.symmetry = symmetry;
+        ++epoch;
+        for (Queue& queue : queues)
+            queue.count = 0;
+    }
+    wake.notify_all();
+}
+
+int PuzzleCache::neediest() const {
+    int best = -1, bestCount = config.depth;
+    for (int level = 0; level < kLevels; ++level) {
+        int count = queues[level].count + inFlight[level];
+        if (count < bestCount) {
+            best = level;
+            bestCount = count;
+        }
+    }
+    return best;
+}
+
+void PuzzleCache::run() {
+    Sudoku sudoku;
+    for (;;) {
+        int level;
+        ClueSymmetry symmetry;
+        std::uint64_t started;
+        {
+            std::unique_lock<std::mutex> lock(mutex);
+            wake.wait(lock, [this] { return stop || neediest() >= 0; });
+            if (stop)
+                return;
+            level = neediest();
+            ++inFlight[level];
+            symmetry = config.symmetry;
+            started = epoch;
+        }
+
+        if (level == 3 && minimalPool && symmetry == ClueSymmetry::None)
+            sudoku.generateMinimal(config.minimalEvilClues, *minimalPool);
+        else {
+            sudoku.symmetry = symmetry;
+            sudoku.setDifficulty(level);
+            sudoku.generateSudoku();
+        }
+        Board puzzle = sudoku.board();
+
+        {
+            std::lock_guard<std::mutex> lock(mutex);
+            Queue& queue = queues[level];
+            --inFlight[level];
+            if (started != epoch)
+                continue;
+            queue.puzzles[(queue.head + queue.count) % config.depth] = puzzle;
+            ++queue.count;
+        }
+        if (config.refillInterval.count() > 0) {
+            std::unique_lock<std::mutex> lock(mutex);
+            wake.wait_for(lock, config.refillInterval, [this] { return stop; });
+        }
+    }
+}
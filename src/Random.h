@@ -0,0 +1,87 @@
+#pragma once
+
+#include <cstdint>
+#include <iterator>
+#include <random>
+#include <utility>
+
+// xoshiro256** seeded through splitmix64. Bounded draws and shuffles are done
+// here rather than with <random> distributions and std::shuffle, whose output
+// differs between standard libraries, so a seed gives the same puzzle
+// everywhere.
+class Rng
+{
+public:
+    using result_type = std::uint64_t;
+
+    Rng() : Rng(entropy()) {}
+    explicit Rng(std::uint64_t seed) { this->seed(seed); }
+
+    // A fresh seed from std::random_device
+    static std::uint64_t entropy();
+    void seed(std::uint64_t seed);
+
+    static constexpr result_type min() { return 0; }
+    static constexpr result_type max() { return ~result_type(0); }
+    result_type operator()();
+
+    // Uniform in [0, bound), bound > 0
+    std::uint32_t bounded(std::uint32_t bound);
+    // Uniform in [lo, hi]
+    int range(int lo, int hi) { return lo + int(bounded(std::uint32_t(hi - lo + 1))); }
+    // Uniform in [0, 1)
+    double unit() { return double((*this)() >> 11) * 0x1.0p-53; }
+    template <typename It>
+    void shuffle(It first, It last);
+
+private:
+    std::uint64_t s[4];
+};
+
+std::uint64_t Rng::entropy() {
+    std::random_device device;
+    return std::uint64_t(device()) << 32 | device();
+}
+
+void Rng::seed(std::uint64_t seed) {
+    for (std::uint64_t& word : s) {
+        std::uint64_t z = (seed += 0x9E3779B97F4A7C15ull);
+        z = (z ^ (z >> 30)) * 0xBF58476D1CE4E5B9ull;
+        z = (z ^ (z >> 27)) * 0x94D049BB133111EBull;
+        word = z ^ (z >> 31);
+    }
+}
+
+Rng::result_type Rng::operator()() {
+    auto rotl = [](std::uint64_t x, int k) { return (x << k) | (x >> (64 - k)); };
+    std::uint64_t result = rotl(s[1] * 5, 7) * 9;
+    std::uint64_t t = s[1] << 17;
+    s[2] ^= s[0];
+    s[3] ^= s[1];
+    s[1] ^= s[2];
+    s[0] ^= s[3];
+    s[2] ^= t;
+    s[3] = rotl(s[3], 45);
+    return result;
+}
+
+// Lemire's multiply-and-reject, usually without a division
+std::uint32_t Rng::bounded(std::uint32_t bound) {
+    std::uint64_t m = ((*this)() >> 32) * bound;
+    std::uint32_t low = std::uint32_t(m);
+    if (low < bound) {
+        std::uint32_t threshold = -bound % bound;
+        while (low < threshold) {
+            m = ((*this)() >> 32) * bound;
+            low = std::uint32_t(m);
+        }
+    }
+    return std::uint32_t(m >> 32);
+}
+
+template <typename It>
+void Rng::shuffle(It first, It last) {
+    auto n = std::distance(first, last);
+    for (auto i = n - 1; i > 0; --i)
+        std::swap(first[i], first[bounded(std::uint32_t(i + 1))]);
+}
@@ -0,0 +1,40 @@
+#pragma once
+
+#include <atomic>
+#include <chrono>
+#include <cstdint>
+#include <functional>
+
+enum class SolveStatus
+{
+    Solved, Unsolvable, TimedOut, Cancelled
+};
+
+// Bounds a solve: a deadline, a cancellation token and a progress callback.
+// Solvers poll it every `interval` search nodes, so the cost of checking the
+// clock stays off the hot path.
+struct SolveControl
+{
+    std::chrono::steady_clock::time_point deadline = std::chrono::steady_clock::time_point::max();
+    const std::atomic<bool>* cancel = nullptr;
+    // Receives the node count and the current search depth
+    std::function<void(std::uint64_t nodes, int depth)> progress;
+    std::uint64_t interval = 4096;
+
+    // Reports progress, returns true and sets reason when the search must stop
+    bool shouldStop(std::uint64_t nodes, int depth, SolveStatus& reason) const;
+};
+
+bool SolveControl::shouldStop(std::uint64_t nodes, int depth, SolveStatus& reason) const {
+    if (progress)
+        progress(nodes, depth);
+    if (cancel && cancel->load(std::memory_order_relaxed)) {
+        reason = SolveStatus::Cancelled;
+        return true;
+    }
+    if (deadline != std::chrono::steady_clock::time_point::max() && std::chrono::steady_clock::now() >= deadline) {
+        reason = SolveStatus::TimedOut;
+        return true;
+    }
+    return false;
+}
@@ -0,0 +1,409 @@
+#pragma once
+
+#include <algorithm>
+#include <atomic>
+#include <bit>
+#include <cstdint>
+#include <vector>
+#include "Board.h"
+#include "Kernels.h"
+#include "SolveControl.h"
+#include "ThreadPool.h"
+
+// Backtracking solver that keeps a 9-bit occupancy mask per row, column and box
+// (UnitMasks), so the candidates of a cell are a single AND of three masks
+// instead of a scan over 27 cells.
+class Solver
+{
+public:
+    static constexpr std::uint16_t kAllDigits = UnitMasks::kAllDigits;
+
+    enum class Branching
+    {
+        FirstEmpty,     // row-major order, matches the original solver's output
+        MostConstrained // empty cell with the fewest candidates (MRV)
+    };
+
+    // Loads a board into the masks, returns false if two givens conflict
+    bool load(const Board& board);
+    // Solves the loaded board and writes the solution into board
+    bool solve(Board& board);
+    // Same, but stops at the control's deadline or cancellation. Only a
+    // Solved status writes board; after a stop the board must be reloaded.
+    SolveStatus solve(Board& board, const SolveControl& control);
+    // Counts solutions of the loaded board, stopping once `limit` are found.
+    // The loaded state is left as it was, so cells can be edited between calls.
+    int countSolutions(int limit);
+
+    // Same as solve and countSolutions, but the search tree is split at a
+    // shallow depth and the subtrees run as pool tasks. The first task to
+    // reach the result stops the others.
+    bool solveParallel(Board& board, ThreadPool& pool);
+    int countSolutionsParallel(int limit, ThreadPool& pool);
+
+    const Board& board() const { return cells; }
+
+    std::uint16_t candidates(int cell) const;
+    void place(int cell, int num);
+    void remove(int cell);
+
+public:
+    Branching branching = Branching::FirstEmpty;
+    // Fill naked and hidden singles to a fixed point before every guess
+    bool propagate = true;
+    // Search nodes (guesses tried) during the last solve or count
+    std::uint64_t nodes = 0;
+
+private:
+    // State shared by the tasks of one parallel search
+    struct SearchShared
+    {
+        std::atomic<bool> stop{ false };
+        std::atomic<int> found{ 0 };
+    };
+
+    // Next cell to branch on, 81 when the board is full. In FirstEmpty mode
+    // pos walks the ordered list of empty cells past the ones filled since.
+    int pickCell(int& pos) const;
+    void orderEmptyCells();
+    bool search();
+    // Returns false on a contradiction; every placement is recorded on the trail
+    bool propagateSingles();
+    void undo(int mark);
+    // Copies of this solver at every open node `depth` guesses below the root
+    void split(int depth, std::vector<Solver>& frontier);
+    std::vector<Solver> splitFrontier(unsigned threads);
+    void runParallel(std::vector<Solver>& frontier, ThreadPool& pool, SearchShared& shared, Board* result);
+
+    Board cells{};
+    UnitMasks units;
+    // Cells filled by propagation, undone in reverse when a branch fails
+    std::uint8_t trail[9 * 9]{};
+    int trailSize = 0;
+    // Cells that were empty when the search started, in row-major order
+    std::uint8_t order[9 * 9]{};
+    int orderSize = 0;
+    struct Frame
+    {
+        std::uint8_t cell, pos, mark;
+        std::uint16_t untried;
+    };
+    Frame stack[9 * 9]{};
+    // Search stops once `found` reaches `limit`; the solution is kept on the
+    // board only when keepSolution is set
+    int limit = 1, found = 0;
+    bool keepSolution = true;
+    SearchShared* shared = nullptr;
+    const SolveControl* control = nullptr;
+    std::uint64_t nextPoll = 0;
+    bool interrupted = false;
+    SolveStatus stopReason = SolveStatus::Solved;
+};
+
+bool Solver::load(const Board& board) {
+    cells.fill(0);
+    trailSize = 0;
+    units = {};
+
+    for (int cell = 0; cell < 9 * 9; ++cell) {
+        int num = board[cell];
+        if (num == 0)
+            continue;
+        if (!(candidates(cell) & (1 << (num - 1))))
+            return false;
+        place(cell, num);
+    }
+    return true;
+}
+
+bool Solver::solve(Board& board) {
+    nodes = 0;
+    limit = 1;
+    found = 0;
+    keepSolution = true;
+    interrupted = false;
+    nextPoll = 0;
+    orderEmptyCells();
+    if (!search() || interrupted)
+        return false;
+    board = cells;
+    return true;
+}
+
+SolveStatus Solver::solve(Board& board, const SolveControl& control) {
+    this->control = &control;
+    bool solved = solve(board);
+    this->control = nullptr;
+    if (interrupted)
+        return stopReason;
+    return solved ? SolveStatus::Solved : SolveStatus::Unsolvable;
+}
+
+int Solver::countSolutions(int limit) {
+    nodes = 0;
+    this->limit = limit;
+    found = 0;
+    keepSolution = false;
+    orderEmptyCells();
+    search();
+    return found;
+}
+
+std::uint16_t Solver::candidates(int cell) const {
+    return units.candidates(cell);
+}
+
+void Solver::place(int cell, int num) {
+    cells[cell] = num;
+    units.add(cell, num);
+}
+
+void Solver::remove(int cell) {
+    units.erase(cell, cells[cell]);
+    cells[cell] = 0;
+}
+
+int Solver::pickCell(int& pos) const {
+    if (branching == Branching::FirstEmpty) {
+        while (pos < orderSize && cells[order[pos]] != 0)
+            ++pos;
+        return pos < orderSize ? order[pos] : 9 * 9;
+    }
+
+    CandidateScan scan;
+    scanCandidates(cells, units.rows, units.cols, units.boxes, scan);
+    int best = 9 * 9, bestCount = 10;
+    for (int cell = 0; cell < 9 * 9; ++cell) {
+        if (cells[cell] != 0)
+            continue;
+        int count = std::popcount(scan.masks[cell]);
+        if (count < bestCount) {
+            best = cell;
+            bestCount = count;
+            if (count <= 1)
+                break; // Forced or dead cell, nothing beats it
+        }
+    }
+    return best;
+}
+
+void Solver::orderEmptyCells() {
+    orderSize = 0;
+    for (int cell = 0; cell < 9 * 9; ++cell)
+        if (cells[cell] == 0)
+            order[orderSize++] = std::uint8_t(cell);
+}
+
+bool Solver::propagateSingles() {
+    bool changed = true;
+    while (changed) {
+        changed = false;
+
+        // Naked singles: cells with one candidate left, found for the whole
+        // board at once by the candidate kernel
+        CandidateScan scan;
+        scanCandidates(cells, units.rows, units.cols, units.boxes, scan);
+        if (scan.contradiction)
+            return false;
+        for (int word = 0; word < 2; ++word) {
+            for (std::uint64_t bits = scan.singles[word]; bits != 0; bits &= bits - 1) {
+                int cell = word * 64 + std::countr_zero(bits);
+                // An earlier single in the same unit may have taken the digit
+                std::uint16_t mask = candidates(cell) & scan.masks[cell];
+                if (mask == 0)
+                    return false;
+                place(cell, std::countr_zero(mask) + 1);
+                trail[trailSize++] = cell;
+                changed = true;
+            }
+        }
+
+        // Hidden singles: digits that fit in only one cell of a unit
+        for (const auto& unit : kUnits) {
+            std::uint16_t once = 0, twice = 0, placed = 0;
+            for (int cell : unit) {
+                if (cells[cell] != 0) {
+                    placed |= 1 << (cells[cell] - 1);
+                    continue;
+                }
+                std::uint16_t mask = candidates(cell);
+                twice |= once & mask;
+                once |= mask;
+            }
+            if ((once | placed) != kAllDigits)
+                return false; // Some digit has no place left in this unit
+            std::uint16_t hidden = once & ~twice;
+            if (hidden == 0)
+                continue;
+            for (int cell : unit) {
+                if (cells[cell] != 0)
+                    continue;
+                std::uint16_t mask = candidates(cell) & hidden;
+                if (mask == 0)
+                    continue;
+                if (mask & (mask - 1))
+                    return false; // Two digits need this same cell
+                place(cell, std::countr_zero(mask) + 1);
+                trail[trailSize++] = cell;
+                changed = true;
+            }
+        }
+    }
+    return true;
+}
+
+void Solver::undo(int mark) {
+    while (trailSize > mark)
+        remove(trail[--trailSize]);
+}
+
+// Depth-first search with an explicit stack, one frame per guess, so it runs
+// in constant memory and is safe on small worker stacks. In FirstEmpty mode
+// it keeps the row-major, ascending-digit order of the old scanning solver, so
+// both find the same solution: propagation only fills cells that are forced in
+// every solution below a node. Returns true once the solution limit is reached.
+bool Solver::search() {
+    int depth = 0;
+    int pos = 0;
+    for (;;) {
+        // Enter a node: propagate, then either record a solution or push a frame
+        if (shared && shared->stop.load(std::memory_order_relaxed))
+            return true; // Another task finished, give up without a result
+        if (control && nodes >= nextPoll) {
+            nextPoll = nodes + control->interval;
+            if (control->shouldStop(nodes, depth, stopReason)) {
+                interrupted = true;
+                return true;
+            }
+        }
+        int mark = trailSize;
+        if (propagate && !propagateSingles()) {
+            undo(mark);
+        }
+        else if (int cell = pickCell(pos); cell == 9 * 9) {
+            bool done = ++found >= limit;
+            if (shared && ++shared->found >= limit)
+                shared->stop = true;
+            done = done || (shared && shared->stop);
+            if (done && keepSolution)
+                return true;
+            undo(mark);
+            if (done) {
+                // Leave the loaded board as it was
+                while (depth > 0) {
+                    Frame& frame = stack[--depth];
+                    remove(frame.cell);
+                    undo(frame.mark);
+                }
+                return true;
+            }
+        }
+        else {
+            stack[depth++] = { std::uint8_t(cell), std::uint8_t(pos), std::uint8_t(mark), candidates(cell) };
+        }
+
+        // Backtrack to the deepest frame with an untried candidate and place it
+        for (;;) {
+            if (depth == 0)
+                return false;
+            Frame& frame = stack[depth - 1];
+            if (cells[frame.cell] != 0)
+                remove(frame.cell);
+            if (frame.untried != 0)
+                break;
+            undo(frame.mark);
+            --depth;
+        }
+        Frame& frame = stack[depth - 1];
+        int num = std::countr_zero(frame.untried) + 1;
+        frame.untried &= frame.untried - 1;
+        ++nodes;
+        place(frame.cell, num);
+        pos = frame.pos + 1;
+    }
+}
+
+void Solver::split(int depth, std::vector<Solver>& frontier) {
+    int mark = trailSize;
+    if (propagate && !propagateSingles()) {
+        undo(mark);
+        return;
+    }
+
+    int pos = 0;
+    int cell = pickCell(pos);
+    if (cell == 9 * 9 || depth == 0) {
+        frontier.push_back(*this);
+        undo(mark);
+        return;
+    }
+
+    std::uint16_t mask = candidates(cell);
+    for (int num = 1; num <= 9; ++num) {
+        if (!(mask & (1 << (num - 1))))
+            continue;
+        ++nodes;
+        place(cell, num);
+        split(depth - 1, frontier);
+        remove(cell);
+    }
+    undo(mark);
+}
+
+// Deepens the split until there are a few subtrees per thread to balance
+std::vector<Solver> Solver::splitFrontier(unsigned threads) {
+    constexpr int kMaxSplitDepth = 6;
+    orderEmptyCells();
+    std::vector<Solver> frontier;
+    for (int depth = 1; depth <= kMaxSplitDepth; ++depth) {
+        frontier.clear();
+        nodes = 0;
+        split(depth, frontier);
+        if (frontier.size() >= 4 * threads)
+            break;
+    }
+    return frontier;
+}
+
+void Solver::runParallel(std::vector<Solver>& frontier, ThreadPool& pool, SearchShared& shared, Board* result) {
+    std::atomic<std::uint64_t> taskNodes{ 0 };
+    std::atomic<bool> claimed{ false };
+    ThreadPool::Group group;
+    for (Solver& task : frontier) {
+        pool.submit(group, [&] {
+            task.shared = &shared;
+            task.nodes = 0;
+            task.search();
+            taskNodes += task.nodes;
+            // A task that was stopped early has found nothing
+            if (result && task.found > 0 && !claimed.exchange(true))
+                *result = task.cells;
+        });
+    }
+    pool.wait(group);
+    nodes += taskNodes;
+}
+
+bool Solver::solveParallel(Board& board, ThreadPool& pool) {
+    limit = 1;
+    found = 0;
+    keepSolution = true;
+    std::vector<Solver> frontier = splitFrontier(pool.size());
+    SearchShared shared;
+    Board result{};
+    runParallel(frontier, pool, shared, &result);
+    if (shared.found == 0)
+        return false;
+    board = result;
+    return true;
+}
+
+int Solver::countSolutionsParallel(int limit, ThreadPool& pool) {
+    this->limit = limit;
+    found = 0;
+    keepSolution = false;
+    std::vector<Solver> frontier = splitFrontier(pool.size());
+    SearchShared shared;
+    runParallel(frontier, pool, shared, nullptr);
+    return std::min(shared.found.load(), limit);
+}
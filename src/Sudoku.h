@@ -2,109 +2,140 @@
 
 #include <vector>
 #include <algorithm>
-#include <numeric>
-#include <random>
-#include <unordered_map>
-#include <set>
 #include "util.h"
+#include "Board.h"
+#include "Solver.h"
+#include "DancingLinks.h"
+#include "GridGenerator.h"
+#include "MinimalGenerator.h"
+#include "Random.h"
+#include "Symmetry.h"
 
-enum class State
+enum class State : std::uint8_t
 {
     Start, Empty, Valid, Unvalid
 };
 
+enum class SolverBackend
+{
+    Backtracking, DancingLinks
+};
+
+// Pattern kept by the clues of a generated puzzle
+enum class ClueSymmetry
+{
+    None, Rotational, Mirror, Diagonal
+};
+
+// The cell paired with cell under symmetry, cell itself on the axis
+inline int symmetricCell(int cell, ClueSymmetry symmetry)
+{
+    int row = cell / 9, col = cell % 9;
+    switch (symmetry)
+    {
+    case ClueSymmetry::Rotational:
+        return 9 * 9 - 1 - cell;
+    case ClueSymmetry::Mirror:
+        return row * 9 + 8 - col;
+    case ClueSymmetry::Diagonal:
+        return col * 9 + row;
+    default:
+        return cell;
+    }
+}
+
 class Sudoku
 {
 private:
-    std::pair<int, int> getSubgridIndices(int i, int j);
-    std::vector<std::pair<int, int>> getSubgridCells(int subgridRow, int subgridCol);
-    std::vector<std::pair<int, int>> getOtherRowsCols(int i, int j);
     int difficulty;
 public:
     Sudoku();
 
-    const bool isValidSudoku(const std::vector<std::vector<int>>& board);
-    const bool isValid(const std::vector<std::vector<int>>& board, int row, int col, int num);
+    const bool isValidSudoku(const Board& board);
+    const bool isValid(const Board& board, int row, int col, int num);
     // Function to solve Sudoku recursively
-    bool solveSudoku(std::vector<std::vector<int>>& board);
+    bool solveSudoku(Board& board);
+    // Bounded by a deadline, cancellation token and progress callback; this
+    // path always runs on the calling thread
+    SolveStatus solveSudoku(Board& board, const SolveControl& control);
+    // Counts solutions up to limit, a limit of 2 is a uniqueness test
+    int countSolutions(const Board& board, int limit);
 
-    // Function to shuffle rows and columns
+    // Applies a random symmetry of the grid: digits, bands, stacks, rows,
+    // columns and transpose
     void shuffle();
     // Function to generate a random Sudoku puzzle
     void generateSudoku();
     void setDifficulty(int difficulty_level);
+    // Reseeds rng and generates; the same seed, level and symmetry always
+    // give the same puzzle
+    void generate(std::uint64_t seed, int difficulty_level, ClueSymmetry clue_symmetry = ClueSymmetry::None);
+    // Generates a minimal puzzle, searching removal orders on pool; returns
+    // false when only a puzzle above targetClues was found
+    bool generateMinimal(int targetClues, ThreadPool& pool);
 
-    std::vector<int> findAll();
-    std::vector<std::pair<int, int>> getAllColored();
+    // Other cells holding the active cell's digit
+    CellSet findAll() const;
+    // Cells sharing a row, column or box with the active cell
+    CellSet getAllColored() const;
 
-    void initializeCellNumbers();
-    void initializeStates();
+    // The board being played; edits go through setCell and setBoard so the
+    // digit sets stay in step with it
+    const Board& board() const { return grid; }
+    void setCell(int cell, int num);
+    void setBoard(const Board& board);
 
-    void updateGrid();
+    void initializeStates();
+private:
+    // Flat and trivially copyable, so snapshots and handoffs are plain copies
+    Board grid{};
+    // Positions of each digit in grid, digitCells[0] is unused
+    CellSet digitCells[10];
 public:
     int active = 0;
-    std::vector<int> cell_numbers;
-    std::vector<std::vector<int>> grid, solved, start;
-    std::unordered_map<int, State> states;
+    // The givens of the board being played and the cheat solution
+    Board solved{}, start{};
+    // One byte per cell, indexed like grid
+    std::array<State, 9 * 9> states{};
+    SolverBackend backend = SolverBackend::Backtracking;
+    Solver solver;
+    DancingLinks dlx;
+    GridGenerator gridGenerator;
+    MinimalGenerator minimalGenerator;
+    // Clues are removed in pairs that keep this pattern
+    ClueSymmetry symmetry = ClueSymmetry::None;
+    // Drives every random choice of the generator
+    Rng rng;
+    // When set, the backtracking solver splits its search over this pool
+    ThreadPool* pool = nullptr;
+    // Search nodes of the last solveSudoku call
+    std::uint64_t nodes = 0;
+    // Uniqueness checks made by the last generateSudoku or generateMinimal
+    std::uint64_t solverCalls = 0;
 };
 
-std::pair<int, int> Sudoku::getSubgridIndices(int i, int j) {
-    int subgridRow = i / 3;
-    int subgridCol = j / 3;
-    return std::make_pair(subgridRow, subgridCol);
-}
-
-std::vector<std::pair<int, int>> Sudoku::getSubgridCells(int subgridRow, int subgridCol) {
-    std::vector<std::pair<int, int>> subgridCells;
-    for (int i = subgridRow * 3; i < (subgridRow + 1) * 3; ++i) {
-        for (int j = subgridCol * 3; j < (subgridCol + 1) * 3; ++j) {
-            subgridCells.push_back(std::make_pair(i, j));
-        }
-    }
-
-    return subgridCells;
-}
-
-std::vector<std::pair<int, int>> Sudoku::getOtherRowsCols(int i, int j) {
-    std::vector<std::pair<int, int>> result;
-    // Add all cells from the same row except (i, j)
-    for (int col = 0; col < 9; ++col) {
-        if (col != j) {
-            result.emplace_back(i, col);
-        }
-    }
-    // Add all cells from the same column except (i, j)
-    for (int row = 0; row < 9; ++row) {
-        if (row != i) {
-            result.emplace_back(row, j);
-        }
-    }
-    return result;
-}
-
 Sudoku::Sudoku()
 {
     setDifficulty(1);
-    cell_numbers.assign(9 * 9, 0);
-    grid.assign(9, std::vector<int>(9, 0));
 }
 
-const bool Sudoku::isValidSudoku(const std::vector<std::vector<int>>& board) {
-    std::vector<std::vector<bool>> rowFlag(9, std::vector<bool>(9, false));
-    std::vector<std::vector<bool>> colFlag(9, std::vector<bool>(9, false));
-    std::vector<std::vector<bool>> boxFlag(9, std::vector<bool>(9, false));
+const bool Sudoku::isValidSudoku(const Board& board) {
+    std::uint16_t rowFlag[9]{}, colFlag[9]{}, boxFlag[9]{};
 
     for (int i = 0; i < 9; ++i) {
         for (int j = 0; j < 9; ++j) {
-            if (board[i][j] != 0) {
-                int num = board[i][j] - 1;
-                int k = i / 3 * 3 + j / 3;
-                if (rowFlag[i][num] || colFlag[j][num] || boxFlag[k][num]) {
+            int value = board[get1DIndex(i, j, 9)];
+            if (value != 0) {
+                std::uint16_t bit = 1 << (value - 1);
+                int k = boxOf(i, j);
+                if ((rowFlag[i] | colFlag[j] | boxFlag[k]) & bit) {
                     return false;
                 }
-                rowFlag[i][num] = colFlag[j][num] = boxFlag[k][num] = true;
+                rowFlag[i] |= bit;
+                colFlag[j] |= bit;
+                boxFlag[k] |= bit;
             }
-            else if (board[i][j] == 0) {
+            else {
                 // If there's an empty cell, it's not a complete solution yet, so return true
                 return false;
             }
@@ -113,101 +144,127 @@ const bool Sudoku::isValidSudoku(const std::vector<std::vector<int>>& board) {
     return true;
 }
 
-const bool Sudoku::isValid(const std::vector<std::vector<int>>& board, int row, int col, int num) {
+const bool Sudoku::isValid(const Board& board, int row, int col, int num) {
     // Check row
     for (int i = 0; i < 9; ++i) {
-        if (board[row][i] == num) return false;
+        if (board[get1DIndex(row, i, 9)] == num) return false;
     }
     // Check column
     for (int i = 0; i < 9; ++i) {
-        if (board[i][col] == num) return false;
+        if (board[get1DIndex(i, col, 9)] == num) return false;
     }
     // Check subgrid
     int startRow = row - row % 3;
     int startCol = col - col % 3;
     for (int i = 0; i < 3; ++i) {
         for (int j = 0; j < 3; ++j) {
-            if (board[i + startRow][j + startCol] == num) return false;
+            if (board[get1DIndex(i + startRow, j + startCol, 9)] == num) return false;
         }
     }
     return true;
 }
 
 // Function to solve Sudoku recursively
-bool Sudoku::solveSudoku(std::vector<std::vector<int>>& board) {
-    for (int row = 0; row < 9; ++row) {
-        for (int col = 0; col < 9; ++col) {
-            if (board[row][col] == 0) {
-                for (int num = 1; num <= 9; ++num) {
-                    if (isValid(board, row, col, num)) {
-                        board[row][col] = num;
-                        if (solveSudoku(board)) {
-                            return true;
-                        }
-                        board[row][col] = 0; // Backtrack
-                    }
-                }
-                return false;
-            }
-        }
+bool Sudoku::solveSudoku(Board& board) {
+    Board flat = board;
+    bool solved;
+    if (backend == SolverBackend::DancingLinks) {
+        solved = dlx.solve(flat);
+        nodes = dlx.nodes;
+    }
+    else {
+        solved = solver.load(flat) && (pool ? solver.solveParallel(flat, *pool) : solver.solve(flat));
+        nodes = solver.nodes;
     }
+    if (!solved)
+        return false;
+    board = flat;
     return true;
 }
 
-// Function to shuffle rows and columns
-void Sudoku::shuffle() {
-    std::random_device rd;
-    std::mt19937 g(rd());
-    // Shuffle rows within each block
-    for (int i = 0; i < 9; i += 3) {
-        std::shuffle(grid.begin() + i, grid.begin() + i + 3, g);
+SolveStatus Sudoku::solveSudoku(Board& board, const SolveControl& control) {
+    Board flat = board;
+    SolveStatus status;
+    if (backend == SolverBackend::DancingLinks) {
+        status = dlx.solve(flat, control);
+        nodes = dlx.nodes;
     }
-    // Transpose the grid
-    for (int i = 0; i < 9; ++i) {
-        for (int j = i + 1; j < 9; ++j) {
-            std::swap(grid[i][j], grid[j][i]);
-        }
+    else {
+        status = solver.load(flat) ? solver.solve(flat, control) : SolveStatus::Unsolvable;
+        nodes = solver.nodes;
+    }
+    if (status == SolveStatus::Solved)
+        board = flat;
+    return status;
+}
+
+int Sudoku::countSolutions(const Board& board, int limit) {
+    int count = 0;
+    if (backend == SolverBackend::DancingLinks) {
+        count = dlx.countSolutions(board, limit);
+        nodes = dlx.nodes;
     }
-    // Shuffle columns within each block
-    for (int i = 0; i < 9; i += 3) {
-        std::shuffle(grid.begin() + i, grid.begin() + i + 3, g);
+    else {
+        if (solver.load(board))
+            count = pool ? solver.countSolutionsParallel(limit, *pool) : solver.countSolutions(limit);
+        nodes = solver.nodes;
     }
+    return count;
+}
+
+// Applies a random symmetry of the grid: digits, bands, stacks, rows,
+// columns and transpose
+void Sudoku::shuffle() {
+    Board shuffled;
+    GridTransform::random(rng).apply(grid, shuffled);
+    setBoard(shuffled);
 }
 
 // Function to generate a random Sudoku puzzle
 void Sudoku::generateSudoku() {
-    // Initialize grid with zeros
-    grid.assign(9, std::vector<int>(9, 0));
-    // Solve the Sudoku
-    solveSudoku(grid);
-    // Shuffle rows, columns, and numbers
-    shuffle();
-    // Remove numbers to create a puzzle
-    std::random_device rd;
-    std::mt19937 gen(rd());
-    std::vector<int> indices(81);
-    std::iota(indices.begin(), indices.end(), 0);
-    std::shuffle(indices.begin(), indices.end(), gen);
-    for (int i = 0; i < difficulty; ++i) {
-        int row = indices[i] / 9;
-        int col = indices[i] % 9;
-        int temp = grid[row][col];
-        grid[row][col] = 0;
-        // Check uniqueness
-        std::vector<std::vector<int>> tempGrid = grid;
-        if (!solveSudoku(tempGrid)) {
-            grid[row][col] = temp; // If removing the number makes the puzzle unsolvable, revert the change
+    // Start from a random complete grid, already under a random symmetry
+    Board full;
+    gridGenerator.generate(full, rng);
+    // Remove numbers to create a puzzle, one symmetry orbit at a time
+    int indices[9 * 9], orbits = 0;
+    for (int cell = 0; cell < 9 * 9; ++cell)
+        if (symmetricCell(cell, symmetry) >= cell)
+            indices[orbits++] = cell;
+    rng.shuffle(indices, indices + orbits);
+    // Removals are tried directly on the solver's masks, counting stops at a
+    // second solution and leaves the loaded board as it was
+    Solver::Branching branching = solver.branching;
+    solver.branching = Solver::Branching::MostConstrained;
+    solver.load(full);
+    solverCalls = 0;
+    // Only removals that keep the solution unique count towards difficulty
+    for (int i = 0, removed = 0; i < orbits && removed < difficulty; ++i) {
+        int cell = indices[i], mate = symmetricCell(cell, symmetry);
+        int size = mate != cell ? 2 : 1;
+        // A pair would overshoot the target by one, try the next orbit
+        if (removed + size > difficulty)
+            continue;
+        int temp = solver.board()[cell], mateTemp = solver.board()[mate];
+        solver.remove(cell);
+        if (mate != cell)
+            solver.remove(mate);
+        ++solverCalls;
+        // Check uniqueness, once for the whole orbit
+        if (solver.countSolutions(2) != 1) {
+            // If removing the numbers makes the solution ambiguous, revert the change
+            solver.place(cell, temp);
+            if (mate != cell)
+                solver.place(mate, mateTemp);
             continue;
         }
-
+        removed += size;
     }
+    solver.branching = branching;
+    setBoard(solver.board());
 }
 
 void Sudoku::setDifficulty(int difficulty_level)
 {
-    std::random_device seed;
-    std::mt19937 gen{ seed() }; // seed the generator
-
     // Easy
     int min = 35, max = 39;
     switch (difficulty_level)
@@ -225,56 +282,61 @@ void Sudoku::setDifficulty(int difficulty_level)
         min = 17; max = 24;
         break;
     }
-    std::uniform_int_distribution<> dist{ min, max }; // set min and max
-    difficulty = 81 - dist(gen);
-    SDL_Log("%d", 81 - difficulty);
+    difficulty = 81 - rng.range(min, max);
 }
 
-std::vector<int> Sudoku::findAll()
+bool Sudoku::generateMinimal(int targetClues, ThreadPool& pool)
 {
-    std::vector<int> all;
-    for (int i = 0; i < 9 * 9; i++)
-        if (cell_numbers[active] == cell_numbers[i] && cell_numbers[i] != 0)
-            all.emplace_back(i);
-    return all;
+    minimalGenerator.options.targetClues = targetClues;
+    std::uint64_t calls = minimalGenerator.stats.solverCalls;
+    Board puzzle;
+    bool reached = minimalGenerator.generate(puzzle, rng, pool);
+    solverCalls = minimalGenerator.stats.solverCalls - calls;
+    setBoard(puzzle);
+    return reached;
 }
 
-std::vector<std::pair<int, int>> Sudoku::getAllColored()
+void Sudoku::generate(std::uint64_t seed, int difficulty_level, ClueSymmetry clue_symmetry)
 {
-    std::set<std::pair<int, int>> colored;
-    std::pair<int, int> subgridIndices = getSubgridIndices(get2DIndex(active, 9).first, get2DIndex(active, 9).second);
-    auto subgridCells = getSubgridCells(subgridIndices.first, subgridIndices.second);
-    auto otherRowsCols = getOtherRowsCols(get2DIndex(active, 9).first, get2DIndex(active, 9).second);
+    rng.seed(seed);
+    gridGenerator.restart();
+    symmetry = clue_symmetry;
+    setDifficulty(difficulty_level);
+    generateSudoku();
+}
 
-    for (int i = 0; i < subgridCells.size(); i++)
-    {
-        if (get2DIndex(active, 9) == subgridCells[i])
-            continue;
-        colored.insert(subgridCells[i]);
-    }
-    for (int i = 0; i < otherRowsCols.size(); i++)
-    {
-        colored.insert(otherRowsCols[i]);
-    }
-    return std::vector<std::pair<int, int>>(colored.begin(), colored.end());
+CellSet Sudoku::findAll() const
+{
+    CellSet all = digitCells[grid[active]];
+    all.reset(active);
+    return all;
 }
 
-void Sudoku::initializeCellNumbers()
+CellSet Sudoku::getAllColored() const
 {
-    for (int i = 0; i < 9; i++)
-        for (int j = 0; j < 9; j++)
-            cell_numbers[get1DIndex(i, j, 9)] = grid[i][j];
+    return kPeerSets[active];
 }
 
-void Sudoku::initializeStates()
+void Sudoku::setCell(int cell, int num)
 {
-    for (int i = 0; i < cell_numbers.size(); i++)
-        cell_numbers[i] == 0 ? states[i] = State::Empty : states[i] = State::Start;
+    digitCells[grid[cell]].reset(cell);
+    grid[cell] = std::uint8_t(num);
+    if (num != 0)
+        digitCells[num].set(cell);
 }
 
-void Sudoku::updateGrid()
+void Sudoku::setBoard(const Board& board)
 {
-    for (int i = 0; i < 9; i++)
-        for (int j = 0; j < 9; j++)
-            grid[i][j] = cell_numbers[get1DIndex(i, j, 9)];
+    grid = board;
+    for (CellSet& cells : digitCells)
+        cells = {};
+    for (int cell = 0; cell < 9 * 9; ++cell)
+        if (grid[cell] != 0)
+            digitCells[grid[cell]].set(cell);
+}
+
+void Sudoku::initializeStates()
+{
+    for (int i = 0; i < 9 * 9; i++)
+        states[i] = grid[i] == 0 ? State::Empty : State::Start;
 }
\ No newline at end of file
@@ -0,0 +1,75 @@
+#pragma once
+
+#include <cstdint>
+#include <iterator>
+#include "Board.h"
+#include "Random.h"
+
+// An element of the validity-preserving group of a Sudoku grid: a digit
+// relabeling, a permutation of the bands and of the stacks, of the rows in
+// each band and the columns in each stack, and an optional transpose.
+// The geometric part is folded into one source-cell table, so applying the
+// whole transform is a single pass of two table lookups per cell.
+struct GridTransform
+{
+    // Cell of the input that lands on each output cell
+    std::uint8_t source[9 * 9];
+    // New label of every digit, 0 stays empty
+    std::uint8_t digits[10];
+
+    static GridTransform identity();
+    // Draws every part independently, so each of the
+    // 9! * 6^8 * 2 transforms is equally likely
+    static GridTransform random(Rng& rng);
+
+    void apply(const Board& in, Board& out) const;
+};
+
+GridTransform GridTransform::identity() {
+    GridTransform t;
+    for (int cell = 0; cell < 9 * 9; ++cell)
+        t.source[cell] = std::uint8_t(cell);
+    for (int d = 0; d < 10; ++d)
+        t.digits[d] = std::uint8_t(d);
+    return t;
+}
+
+GridTransform GridTransform::random(Rng& rng) {
+    // rowOf[r] is the input row shown at output row r, colOf likewise
+    int rowOf[9], colOf[9];
+    int bands[3] = { 0, 1, 2 }, stacks[3] = { 0, 1, 2 };
+    rng.shuffle(std::begin(bands), std::end(bands));
+    rng.shuffle(std::begin(stacks), std::end(stacks));
+    for (int b = 0; b < 3; ++b) {
+        int rows[3] = { 0, 1, 2 }, cols[3] = { 0, 1, 2 };
+        rng.shuffle(std::begin(rows), std::end(rows));
+        rng.shuffle(std::begin(cols), std::end(cols));
+        for (int i = 0; i < 3; ++i) {
+            rowOf[b * 3 + i] = bands[b] * 3 + rows[i];
+            colOf[b * 3 + i] = stacks[b] * 3 + cols[i];
+        }
+    }
+    bool transpose = rng.bounded(2) == 1;
+
+    GridTransform t;
+    for (int row = 0; row < 9; ++row) {
+        for (int col = 0; col < 9; ++col) {
+            int cell = rowOf[row] * 9 + colOf[col];
+            if (transpose)
+                cell = cell % 9 * 9 + cell / 9;
+            t.source[row * 9 + col] = std::uint8_t(cell);
+        }
+    }
+
+    std::uint8_t labels[9] = { 1, 2, 3, 4, 5, 6, 7, 8, 9 };
+    rng.shuffle(std::begin(labels), std::end(labels));
+    t.digits[0] = 0;
+    for (int d = 0; d < 9; ++d)
+        t.digits[d + 1] = labels[d];
+    return t;
+}
+
+void GridTransform::apply(const Board& in, Board& out) const {
+    for (int cell = 0; cell < 9 * 9; ++cell)
+        out[cell] = digits[in[source[cell]]];
+}
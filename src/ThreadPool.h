@@ -0,0 +1,190 @@
+#pragma once
+
+#include <algorithm>
+#include <atomic>
+#include <condition_variable>
+#include <deque>
+#include <functional>
+#include <memory>
+#include <mutex>
+#include <thread>
+#include <vector>
+
+// Work-stealing thread pool. Every worker owns a deque: it pops its own tasks
+// from the back and, when that runs dry, steals from the front of the others.
+// Tasks submitted from a worker go to its own deque, others are dealt out
+// round-robin. Callers wait on a Group of their own tasks, so several users
+// can share one pool.
+class ThreadPool
+{
+public:
+    // Tasks a caller submitted together, and waits for together
+    class Group
+    {
+    public:
+        Group() = default;
+        Group(const Group&) = delete;
+        Group& operator=(const Group&) = delete;
+
+    private:
+        friend class ThreadPool;
+        std::atomic<int> pending{ 0 };
+    };
+
+    explicit ThreadPool(unsigned threads = std::thread::hardware_concurrency());
+    ~ThreadPool();
+
+    void submit(Group& group, std::function<void()> task);
+    // Blocks until every task of group has finished. A task of this pool
+    // that waits runs queued tasks meanwhile, so nested waits cannot deadlock.
+    void wait(Group& group);
+
+    unsigned size() const { return static_cast<unsigned>(queues.size()); }
+
+private:
+    struct Task
+    {
+        std::function<void()> run;
+        Group* group = nullptr;
+    };
+
+    struct Queue
+    {
+        std::mutex mutex;
+        std::deque<Task> tasks;
+    };
+
+    void run(unsigned index);
+    void execute(Task& task);
+    bool pop(unsigned index, Task& task);
+    bool steal(unsigned index, Task& task);
+
+    std::vector<std::unique_ptr<Queue>> queues;
+    std::vector<std::thread> workers;
+    std::mutex sleepMutex;
+    std::condition_variable wake, idle;
+    // Tasks waiting in a deque, and tasks of any group not finished yet
+    std::atomic<int> queued{ 0 }, pending{ 0 };
+    std::atomic<unsigned> nextQueue{ 0 };
+    // Workers blocked in wait, woken by submit so they can help
+    int helpers = 0;
+    bool stop = false;
+
+    static thread_local ThreadPool* currentPool;
+    static thread_local unsigned currentIndex;
+};
+
+thread_local ThreadPool* ThreadPool::currentPool = nullptr;
+thread_local unsigned ThreadPool::currentIndex = 0;
+
+ThreadPool::ThreadPool(unsigned threads) {
+    threads = std::max(threads, 1u);
+    for (unsigned i = 0; i < threads; ++i)
+        queues.push_back(std::make_unique<Queue>());
+    for (unsigned i = 0; i < threads; ++i)
+        workers.emplace_back(&ThreadPool::run, this, i);
+}
+
+ThreadPool::~ThreadPool() {
+    {
+        std::unique_lock<std::mutex> lock(sleepMutex);
+        idle.wait(lock, [this] { return pending == 0; });
+        stop = true;
+    }
+    wake.notify_all();
+    for (std::thread& worker : workers)
+        worker.join();
+}
+
+void ThreadPool::submit(Group& group, std::function<void()> task) {
+    unsigned index = currentPool == this ? currentIndex : nextQueue++ % size();
+    ++group.pending;
+    ++pending;
+    {
+        std::lock_guard<std::mutex> lock(queues[index]->mutex);
+        queues[index]->tasks.push_back({ std::move(task), &group });
+    }
+    bool help;
+    {
+        std::lock_guard<std::mutex> lock(sleepMutex);
+        ++queued;
+        help = helpers > 0;
+    }
+    wake.notify_one();
+    if (help)
+        idle.notify_all();
+}
+
+void ThreadPool::wait(Group& group) {
+    if (currentPool != this) {
+        std::unique_lock<std::mutex> lock(sleepMutex);
+        idle.wait(lock, [&] { return group.pending == 0; });
+        return;
+    }
+    // Blocking a worker here could leave no one to run the group's tasks
+    Task task;
+    while (group.pending > 0) {
+        if (pop(currentIndex, task) || steal(currentIndex, task)) {
+            execute(task);
+            continue;
+        }
+        std::unique_lock<std::mutex> lock(sleepMutex);
+        ++helpers;
+        idle.wait(lock, [&] { return group.pending == 0 || queued > 0; });
+        --helpers;
+    }
+}
+
+// The group may be destroyed by its waiter as soon as its count hits zero
+void ThreadPool::execute(Task& task) {
+    task.run();
+    task.run = nullptr;
+    bool groupDone = --task.group->pending == 0;
+    bool poolDone = --pending == 0;
+    if (groupDone || poolDone) {
+        std::lock_guard<std::mutex> lock(sleepMutex);
+        idle.notify_all();
+    }
+}
+
+bool ThreadPool::pop(unsigned index, Task& task) {
+    Queue& queue = *queues[index];
+    std::lock_guard<std::mutex> lock(queue.mutex);
+    if (queue.tasks.empty())
+        return false;
+    task = std::move(queue.tasks.back());
+    queue.tasks.pop_back();
+    --queued;
+    return true;
+}
+
+bool ThreadPool::steal(unsigned index, Task& task) {
+    for (unsigned i = 1; i < size(); ++i) {
+        Queue& queue = *queues[(index + i) % size()];
+        std::lock_guard<std::mutex> lock(queue.mutex);
+        if (queue.tasks.empty())
+            continue;
+        task = std::move(queue.tasks.front());
+        queue.tasks.pop_front();
+        --queued;
+        return true;
+    }
+    return false;
+}
+
+void ThreadPool::run(unsigned index) {
+    currentPool = this;
+    currentIndex = index;
+    Task task;
+    for (;;) {
+        if (pop(index, task) || steal(index, task)) {
+            execute(task);
+            continue;
+        }
+
+        std::unique_lock<std::mutex> lock(sleepMutex);
+        wake.wait(lock, [this] { return stop || queued > 0; });
+        if (stop)
+            return;
+    }
+}
@@ -2,6 +2,76 @@
 
 #include "SDL2_framerate.h"
 
+#ifndef NDEBUG
+#include <cstdlib>
+#include <new>
+
+// Heap allocations made by each thread. The render loop counts the frames
+// that still allocate once warmed up; the solver and generator threads are
+// free to allocate.
+thread_local std::uint64_t threadAllocations = 0;
+
+void* operator new(std::size_t size)
+{
+    ++threadAllocations;
+    if (void* p = std::malloc(size ? size : 1))
+        return p;
+    throw std::bad_alloc();
+}
+
+void operator delete(void* p) noexcept { std::free(p); }
+void operator delete(void* p, std::size_t) noexcept { std::free(p); }
+
+// ImGui and SDL allocate through malloc, not operator new, so both get their
+// allocators pointed at the same counter before they allocate anything
+void* countedImguiAlloc(std::size_t size, void*)
+{
+    ++threadAllocations;
+    return std::malloc(size);
+}
+
+void countedImguiFree(void* p, void*) { std::free(p); }
+
+void* SDLCALL countedMalloc(std::size_t size)
+{
+    ++threadAllocations;
+    return std::malloc(size);
+}
+
+void* SDLCALL countedCalloc(std::size_t count, std::size_t size)
+{
+    ++threadAllocations;
+    return std::calloc(count, size);
+}
+
+void* SDLCALL countedRealloc(void* p, std::size_t size)
+{
+    ++threadAllocations;
+    return std::realloc(p, size);
+}
+
+void SDLCALL countedFree(void* p) { std::free(p); }
+
+// Frames allowed to allocate while lazily built state settles
+constexpr int kWarmupFrames = 60;
+
+// Frame path allocations after warmup. ImGui still allocates when it first
+// builds a window, such as a tooltip, combo popup or the Cheat window, or
+// grows a buffer, so these are counted rather than asserted on; a count that
+// keeps climbing is the regression to look for.
+struct FrameAllocations
+{
+    int frames = 0, allocatingFrames = 0;
+    std::uint64_t total = 0, worst = 0;
+
+    void log() const
+    {
+        SDL_Log("Frame allocations: %d of %d frames allocated, %llu in all, at most %llu in one",
+            allocatingFrames, frames, static_cast<unsigned long long>(total), static_cast<unsigned long long>(worst));
+    }
+};
+#endif
+
 void draw(App* app)
 {
     SDL_Renderer* renderer = app->GetSDLRenderer();
@@ -32,6 +102,12 @@ void draw(App* app)
 
 int main()
 {
+#ifndef NDEBUG
+    // Before SDL_Init and ImGui::CreateContext, neither may have allocated yet
+    if (SDL_SetMemoryFunctions(countedMalloc, countedCalloc, countedRealloc, countedFree) != 0)
+        SDL_Log("Failed to count SDL allocations: %s\n", SDL_GetError());
+    ImGui::SetAllocatorFunctions(countedImguiAlloc, countedImguiFree);
+#endif
     App app("Sudoku", 800, 575);
     app.SetWindowMinimumSize(400, 305);
 
@@ -61,8 +137,15 @@ int main()
 
     SDL_Event event;
     int quit = 0;
+#ifndef NDEBUG
+    int frame = 0;
+    FrameAllocations frameAllocations;
+#endif
     while (!quit)
     {
+#ifndef NDEBUG
+        std::uint64_t allocated = threadAllocations;
+#endif
         while (SDL_PollEvent(&event))
         {
             ImGui_ImplSDL3_ProcessEvent(&event);
@@ -74,8 +157,12 @@ int main()
             case SDL_EVENT_KEY_DOWN:
                 if (event.key.keysym.sym == SDLK_ESCAPE)
                     quit = 1;
-                if (event.key.keysym.sym == SDLK_k) 
+                if (event.key.keysym.sym == SDLK_k) {
                     SDL_Log("fps = %f", io.Framerate);
+#ifndef NDEBUG
+                    frameAllocations.log();
+#endif
+                }
 
                 app.sudokuProcessKeyboardInput(event.key.keysym.sym);
 
@@ -93,8 +180,27 @@ int main()
 
         draw(&app);
 
+#ifndef NDEBUG
+        if (++frame > kWarmupFrames) {
+            std::uint64_t count = threadAllocations - allocated;
+            ++frameAllocations.frames;
+            if (count != 0) {
+                ++frameAllocations.allocatingFrames;
+                frameAllocations.total += count;
+                // Only a new worst frame is logged, to keep the log readable
+                if (count > frameAllocations.worst) {
+                    frameAllocations.worst = count;
+                    SDL_Log("Frame %d made %llu heap allocations", frame, static_cast<unsigned long long>(count));
+                }
+            }
+        }
+#endif
+
         SDL_framerateDelay(&fps);
     }
+#ifndef NDEBUG
+    frameAllocations.log();
+#endif
  
     return 0;
 }